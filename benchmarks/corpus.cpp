@@ -0,0 +1,205 @@
+#include "corpus.hpp"
+
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+#include <random>
+
+/**
+ * @brief Number of images of a generated corpus, per size.
+ */
+constexpr std::size_t kGeneratedImages = 8;
+
+/**
+ * @brief Font of the rendered text.
+ */
+constexpr int kFont = cv::FONT_HERSHEY_SIMPLEX;
+
+auto GetBenchmarkConfig() -> BenchmarkConfig & {
+  static BenchmarkConfig config;
+  return config;
+}
+
+auto GenerateWords(std::size_t count, std::size_t min_length, std::size_t max_length, unsigned seed)
+    -> std::vector<std::string> {
+  std::mt19937 rng(seed);
+  std::uniform_int_distribution<std::size_t> length_dist(min_length, std::max(min_length, max_length));
+  std::uniform_int_distribution<int> char_dist('a', 'z');
+
+  std::vector<std::string> words;
+  words.reserve(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    std::string word(length_dist(rng), ' ');
+    for (auto &c : word) {
+      c = static_cast<char>(char_dist(rng));
+    }
+    // Labels are usually capitalized.
+    word[0] = static_cast<char>(word[0] - 'a' + 'A');
+    words.push_back(std::move(word));
+  }
+  return words;
+}
+
+auto GenerateTextImage(const cv::Size &size, unsigned seed) -> cv::Mat {
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<double> scale_dist(0.6, 1.4);
+  std::uniform_int_distribution<int> gap_dist(40, 160);
+
+  cv::Mat image(size, CV_8UC3, cv::Scalar(235, 235, 235));
+  const auto words = GenerateWords(512, 3, 10, seed);
+  std::size_t next_word = 0;
+
+  int y = 40;
+  while (y < size.height - 10) {
+    const double scale = scale_dist(rng);
+    const int thickness = scale > 1.0 ? 2 : 1;
+    int x = gap_dist(rng) / 4;
+    int line_height = 0;
+    while (true) {
+      const auto &word = words[next_word++ % words.size()];
+      int baseline = 0;
+      const auto text_size = cv::getTextSize(word, kFont, scale, thickness, &baseline);
+      if (x + text_size.width >= size.width) {
+        break;
+      }
+      cv::putText(image, word, {x, y}, kFont, scale, cv::Scalar(30, 30, 30), thickness, cv::LINE_AA);
+      x += text_size.width + gap_dist(rng);
+      line_height = std::max(line_height, text_size.height + baseline);
+    }
+    y += line_height + gap_dist(rng) / 2;
+  }
+
+  // Sensor noise, so that the denoising stage has some work to do.
+  cv::Mat noise(size, CV_16SC3);
+  cv::RNG noise_rng(seed);
+  noise_rng.fill(noise, cv::RNG::NORMAL, 0, 6);
+  cv::Mat noisy;
+  image.convertTo(noisy, CV_16SC3);
+  noisy += noise;
+  noisy.convertTo(image, CV_8UC3);
+  return image;
+}
+
+auto RenderText(cv::Mat &frame, std::string_view text, const cv::Point &origin) -> cv::Rect {
+  constexpr double scale = 1.0;
+  constexpr int thickness = 2;
+  const std::string str(text);
+  int baseline = 0;
+  const auto text_size = cv::getTextSize(str, kFont, scale, thickness, &baseline);
+  cv::putText(frame, str, origin, kFont, scale, cv::Scalar(0), thickness, cv::LINE_AA);
+  return cv::Rect(origin.x, origin.y - text_size.height, text_size.width, text_size.height + baseline) &
+         cv::Rect(0, 0, frame.cols, frame.rows);
+}
+
+auto GetCorpus(const cv::Size &size) -> const std::vector<cv::Mat> & {
+  // Benchmarks running on several threads load the corpus concurrently.
+  static std::mutex mutex;
+  static std::map<std::pair<int, int>, std::vector<cv::Mat>> corpora;
+  const std::lock_guard lock(mutex);
+
+  auto &corpus = corpora[{size.width, size.height}];
+  if (!corpus.empty()) {
+    return corpus;
+  }
+
+  const auto &directory = GetBenchmarkConfig().corpus_dir_;
+  if (directory.empty()) {
+    for (std::size_t i = 0; i < kGeneratedImages; ++i) {
+      corpus.push_back(GenerateTextImage(size, static_cast<unsigned>(i)));
+    }
+    return corpus;
+  }
+
+  std::vector<cv::String> paths;
+  cv::glob(directory, paths, false);
+  for (const auto &path : paths) {
+    cv::Mat image = cv::imread(path, cv::IMREAD_COLOR);
+    if (image.empty()) {
+      continue;
+    }
+    if (image.size() != size) {
+      cv::resize(image, image, size, 0, 0, cv::INTER_AREA);
+    }
+    corpus.push_back(std::move(image));
+  }
+  return corpus;
+}
+
+auto SaveGeneratedCorpus(std::string_view directory, std::size_t count) -> bool {
+  for (const auto &size : kImageSizes) {
+    for (std::size_t i = 0; i < count; ++i) {
+      const auto path = fmt::format("{}/text_{}x{}_{}.png", directory, size.width, size.height, i);
+      if (!cv::imwrite(path, GenerateTextImage(size, static_cast<unsigned>(i)))) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+auto GenerateDetections(std::size_t count, unsigned seed) -> std::vector<DetectReadResult> {
+  constexpr int line_width = 1920;
+  constexpr int char_width = 12;
+  constexpr int height = 20;
+  std::mt19937 rng(seed);
+  std::uniform_int_distribution<int> gap_dist(10, 80);
+
+  std::vector<DetectReadResult> detections;
+  detections.reserve(count);
+  int x = 0;
+  int y = 0;
+  for (auto &word : GenerateWords(count, 2, 12, seed)) {
+    const int width = static_cast<int>(word.size()) * char_width;
+    if (x + width > line_width) {
+      x = 0;
+      y += 2 * height;
+    }
+    detections.push_back({std::move(word), {x, y, width, height}});
+    x += width + gap_dist(rng);
+  }
+  return detections;
+}
+
+auto GenerateTargets(const std::vector<DetectReadResult> &detections, std::size_t count, std::size_t words_per_target,
+                     unsigned seed) -> std::vector<std::string> {
+  std::mt19937 rng(seed);
+  std::uniform_int_distribution<std::size_t> index_dist(0, detections.size() - 1);
+  std::uniform_int_distribution<int> char_dist('a', 'z');
+  const auto absent = GenerateWords(count * words_per_target, 12, 16, seed + 1);
+
+  std::vector<std::string> targets;
+  targets.reserve(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    std::string target;
+    if (i % 2 == 1) {
+      for (std::size_t w = 0; w < words_per_target; ++w) {
+        target += (w == 0 ? "" : " ") + absent[i * words_per_target + w];
+      }
+      targets.push_back(std::move(target));
+      continue;
+    }
+
+    // Consecutive words of a line, the search rarely fails.
+    std::size_t first = index_dist(rng);
+    for (int attempt = 0; attempt < 100; ++attempt) {
+      const std::size_t last = first + words_per_target - 1;
+      if (last < detections.size() && detections[last].bounding_box_.y == detections[first].bounding_box_.y) {
+        break;
+      }
+      first = index_dist(rng);
+    }
+    for (std::size_t w = 0; w < words_per_target && first + w < detections.size(); ++w) {
+      target += (w == 0 ? "" : " ") + detections[first + w].text_;
+    }
+    // A space is never the last character.
+    std::size_t misread = rng() % target.size();
+    misread += target[misread] == ' ' ? 1 : 0;
+    target[misread] = static_cast<char>(char_dist(rng));
+    targets.push_back(std::move(target));
+  }
+  return targets;
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstddef>
+#include <opencv2/core.hpp>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "textspotter/result_type.hpp"
+
+/**
+ * @struct BenchmarkConfig
+ * @brief Settings of the benchmark suite, read from its command line.
+ */
+struct BenchmarkConfig {
+  std::string corpus_dir_;  // Directory of the images to benchmark, generated images are used if empty.
+  std::string model_path_;  // Path to the EAST model, the benchmarks needing it are skipped if empty.
+};
+
+/**
+ * @brief Gets the settings of the benchmark suite.
+ */
+auto GetBenchmarkConfig() -> BenchmarkConfig &;
+
+/**
+ * @brief Sizes of the images the image benchmarks run on, indexed by their first argument.
+ */
+inline const std::vector<cv::Size> kImageSizes{{640, 480}, {1280, 720}, {1920, 1080}};
+
+/**
+ * @brief Generates random words looking like the labels of a user interface.
+ *
+ * @param count Number of words.
+ * @param min_length Minimum number of characters of a word.
+ * @param max_length Maximum number of characters of a word.
+ * @param seed Seed of the generator, the same seed gives the same words.
+ */
+auto GenerateWords(std::size_t count, std::size_t min_length, std::size_t max_length, unsigned seed)
+    -> std::vector<std::string>;
+
+/**
+ * @brief Renders lines of random words on a light, slightly noisy background.
+ *
+ * @param size Size of the image.
+ * @param seed Seed of the generator, the same seed gives the same image.
+ * @return The image, 8-bit BGR.
+ */
+auto GenerateTextImage(const cv::Size &size, unsigned seed) -> cv::Mat;
+
+/**
+ * @brief Renders a text in black on a frame, as the region recognized by the benchmarks of the engine.
+ *
+ * @param frame The frame, 8-bit grayscale.
+ * @param text The text.
+ * @param origin The bottom left corner of the text.
+ * @return The bounding box of the text in the frame.
+ */
+auto RenderText(cv::Mat &frame, std::string_view text, const cv::Point &origin) -> cv::Rect;
+
+/**
+ * @brief Gets the images of the corpus at a size, loaded or generated on first use.
+ *
+ * @details The images of BenchmarkConfig::corpus_dir_ are resized, so that every size is benchmarked on the same
+ * content. Without a directory, a fixed set of images is generated.
+ *
+ * @param size Size of the images.
+ */
+auto GetCorpus(const cv::Size &size) -> const std::vector<cv::Mat> &;
+
+/**
+ * @brief Writes generated images to a directory, to be inspected or reused as a corpus.
+ *
+ * @param directory The existing directory the images are written to.
+ * @param count Number of images per size of kImageSizes.
+ * @return True on success.
+ */
+auto SaveGeneratedCorpus(std::string_view directory, std::size_t count) -> bool;
+
+/**
+ * @brief Generates the detections of a screen full of text, laid out in lines of words.
+ *
+ * @param count Number of detections.
+ * @param seed Seed of the generator.
+ */
+auto GenerateDetections(std::size_t count, unsigned seed) -> std::vector<DetectReadResult>;
+
+/**
+ * @brief Picks targets among the words of the detections: half of them misread by one character, the other half
+ * absent from the detections.
+ *
+ * @param detections The detections.
+ * @param count Number of targets.
+ * @param words_per_target Number of consecutive words of a line joined into a target.
+ * @param seed Seed of the generator.
+ */
+auto GenerateTargets(const std::vector<DetectReadResult> &detections, std::size_t count, std::size_t words_per_target,
+                     unsigned seed) -> std::vector<std::string>;
@@ -0,0 +1,67 @@
+#include <benchmark/benchmark.h>
+#include <fmt/core.h>
+
+#include <cstdlib>
+#include <string>
+#include <string_view>
+
+#include "corpus.hpp"
+
+/**
+ * @brief Reads the value of a flag of the form --name=value.
+ *
+ * @return True if the argument is the flag.
+ */
+static auto ParseFlag(std::string_view arg, std::string_view name, std::string &value) -> bool {
+  if (arg.substr(0, name.size()) != name) {
+    return false;
+  }
+  value = std::string(arg.substr(name.size()));
+  return true;
+}
+
+int main(int argc, char *argv[]) {
+  for (int i = 1; i < argc; ++i) {
+    if (std::string_view(argv[i]) == "--help") {
+      // Google Benchmark prints its own flags and exits.
+      fmt::println("Suite flags:");
+      fmt::println("  --corpus=<dir>        images to benchmark, resized to every size (default: generated images)");
+      fmt::println("  --model=<path>        EAST model, the detection benchmarks are skipped without it");
+      fmt::println("  --write_corpus=<dir>  write the generated images to an existing directory and exit");
+      fmt::println("  --write_count=<n>     number of images written per size (default: 4)");
+      fmt::println("Save the results with --benchmark_out=results.json --benchmark_out_format=json.\n");
+    }
+  }
+  benchmark::Initialize(&argc, argv);
+
+  // Google Benchmark leaves the flags it does not know, the ones of the suite are read here.
+  std::string write_corpus;
+  std::string write_count = "4";
+  int kept = 1;
+  for (int i = 1; i < argc; ++i) {
+    const std::string_view arg(argv[i]);
+    auto &config = GetBenchmarkConfig();
+    if (ParseFlag(arg, "--corpus=", config.corpus_dir_) || ParseFlag(arg, "--model=", config.model_path_) ||
+        ParseFlag(arg, "--write_corpus=", write_corpus) || ParseFlag(arg, "--write_count=", write_count)) {
+      continue;
+    }
+    argv[kept++] = argv[i];
+  }
+  argc = kept;
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+
+  if (!write_corpus.empty()) {
+    const auto count = std::strtoul(write_count.c_str(), nullptr, 10);
+    if (!SaveGeneratedCorpus(write_corpus, count)) {
+      fmt::println(stderr, "Cannot write the corpus to {}", write_corpus);
+      return 1;
+    }
+    return 0;
+  }
+
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
@@ -0,0 +1,98 @@
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "corpus.hpp"
+#include "textspotter/text_index.hpp"
+#include "textspotter/text_matching.hpp"
+#include "textspotter/utility.hpp"
+
+/**
+ * @brief Number of distinct queries a matching benchmark cycles through.
+ */
+constexpr std::size_t kNumQueries = 256;
+
+/**
+ * @brief Computes the edit distance of word pairs, half of them a word and a misread copy. Argument: word length.
+ */
+static auto BM_CalcLevenshteinDistance(benchmark::State &state) -> void {
+  const auto length = static_cast<std::size_t>(state.range(0));
+  const auto words = GenerateWords(kNumQueries, length, length, 1);
+  const auto others = GenerateWords(kNumQueries, length, length, 2);
+
+  std::mt19937 rng(3);
+  std::vector<std::pair<std::string, std::string>> pairs;
+  for (std::size_t i = 0; i < kNumQueries; ++i) {
+    auto other = others[i];
+    if (i % 2 == 0) {
+      other = words[i];
+      other[rng() % other.size()] = '#';
+    }
+    pairs.emplace_back(words[i], std::move(other));
+  }
+
+  std::size_t next = 0;
+  for (auto _ : state) {
+    const auto &[s1, s2] = pairs[next++ % pairs.size()];
+    benchmark::DoNotOptimize(CalcLevenshteinDistance(s1, s2));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_CalcLevenshteinDistance)->RangeMultiplier(2)->Range(4, 128)->ArgName("length");
+
+/**
+ * @brief Matches single words among the detections of a screen. Arguments: number of detections, whether the
+ * detections are indexed.
+ */
+static auto BM_MatchWord(benchmark::State &state) -> void {
+  const auto detections = GenerateDetections(static_cast<std::size_t>(state.range(0)), 1);
+  const auto targets = GenerateTargets(detections, kNumQueries, 1, 2);
+  const bool indexed = state.range(1) != 0;
+  const TextIndex index(detections);
+
+  std::size_t next = 0;
+  for (auto _ : state) {
+    const auto &target = targets[next++ % targets.size()];
+    benchmark::DoNotOptimize(indexed ? MatchWord(detections, index, target) : MatchWord(detections, target));
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetLabel(indexed ? "indexed" : "linear");
+}
+BENCHMARK(BM_MatchWord)->ArgsProduct({{100, 1000, 10000}, {0, 1}})->ArgNames({"detections", "indexed"});
+
+/**
+ * @brief Builds the index of the detections of a screen. Argument: number of detections.
+ */
+static auto BM_TextIndexBuild(benchmark::State &state) -> void {
+  const auto detections = GenerateDetections(static_cast<std::size_t>(state.range(0)), 1);
+  TextIndex index;
+  for (auto _ : state) {
+    index.Build(detections);
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_TextIndexBuild)->Arg(100)->Arg(1000)->Arg(10000)->ArgName("detections");
+
+/**
+ * @brief Matches groups of consecutive words among the detections of a screen. Arguments: number of detections,
+ * number of words of a group.
+ */
+static auto BM_MatchWordGroups(benchmark::State &state) -> void {
+  const auto detections = GenerateDetections(static_cast<std::size_t>(state.range(0)), 1);
+  std::vector<std::vector<std::string>> targets;
+  for (const auto &target : GenerateTargets(detections, kNumQueries, static_cast<std::size_t>(state.range(1)), 2)) {
+    targets.push_back(SplitStr(target));
+  }
+  const TextIndex index(detections);
+
+  std::size_t next = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(MatchWordGroups(detections, index, targets[next++ % targets.size()]));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_MatchWordGroups)->ArgsProduct({{100, 1000, 10000}, {2, 3}})->ArgNames({"detections", "words"});
@@ -0,0 +1,243 @@
+#include <benchmark/benchmark.h>
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <opencv2/core.hpp>
+#include <stdexcept>
+#include <thread>
+
+#include "corpus.hpp"
+#include "latency.hpp"
+#include "textspotter/detect_read.hpp"
+#include "textspotter/east_detector.hpp"
+#include "textspotter/ocr.hpp"
+#include "textspotter/preprocess.hpp"
+#include "textspotter/thread_pool.hpp"
+
+/**
+ * @brief Highest number of threads of the scaling curves.
+ */
+static const int kMaxThreads = static_cast<int>(std::max(1U, std::thread::hardware_concurrency()));
+
+/**
+ * @brief Gets the EAST detector shared by the detection benchmarks, loaded and warmed up on first use.
+ *
+ * @return The detector, nullptr if no model is configured or it cannot be loaded.
+ */
+static auto GetDetector() -> const EastTextDetector * {
+  static const auto detector = []() -> std::unique_ptr<EastTextDetector> {
+    const auto &model_path = GetBenchmarkConfig().model_path_;
+    if (model_path.empty()) {
+      return nullptr;
+    }
+    try {
+      auto loaded = std::make_unique<EastTextDetector>(model_path.c_str());
+      loaded->Warmup();
+      return loaded;
+    } catch (const cv::Exception &e) {
+      fmt::println(stderr, "Cannot load the EAST model: {}", e.what());
+      return nullptr;
+    }
+  }();
+  return detector.get();
+}
+
+/**
+ * @brief Gets the images a benchmark runs on, reports an error if there is none.
+ */
+static auto GetImages(benchmark::State &state, std::size_t size_index) -> const std::vector<cv::Mat> * {
+  const auto &corpus = GetCorpus(kImageSizes[size_index]);
+  if (corpus.empty()) {
+    state.SkipWithError("the corpus directory holds no image");
+    return nullptr;
+  }
+  return &corpus;
+}
+
+/**
+ * @brief Gets the label of an image size.
+ */
+static auto SizeLabel(std::size_t size_index) -> std::string {
+  return fmt::format("{}x{}", kImageSizes[size_index].width, kImageSizes[size_index].height);
+}
+
+/**
+ * @brief Preprocesses whole images. Arguments: image size, profile (0: default, 1: fast).
+ */
+static auto BM_Preprocess(benchmark::State &state) -> void {
+  const auto size_index = static_cast<std::size_t>(state.range(0));
+  const auto *images = GetImages(state, size_index);
+  if (images == nullptr) {
+    return;
+  }
+  const bool fast = state.range(1) != 0;
+  const auto pipeline = fast ? PreprocessPipeline::Fast() : PreprocessPipeline::Default();
+
+  LatencyRecorder latency;
+  std::size_t next = state.thread_index();
+  for (auto _ : state) {
+    latency.Start();
+    benchmark::DoNotOptimize(pipeline.Run((*images)[next++ % images->size()]));
+    latency.Stop();
+  }
+  latency.Report(state);
+  const auto &image = images->front();
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(image.total() * image.elemSize()));
+  state.SetLabel(SizeLabel(size_index) + (fast ? " fast" : " default"));
+}
+BENCHMARK(BM_Preprocess)
+    ->ArgsProduct({{0, 1, 2}, {0, 1}})
+    ->ArgNames({"size", "fast"})
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Preprocess)
+    ->Args({1, 0})
+    ->ArgNames({"size", "fast"})
+    ->ThreadRange(1, kMaxThreads)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+/**
+ * @brief Detects text with the EAST model. Arguments: image size, mode (0: detect, 1: detectTiled).
+ */
+static auto BM_EastDetect(benchmark::State &state) -> void {
+  const auto *detector = GetDetector();
+  if (detector == nullptr) {
+    state.SkipWithError("no EAST model, pass --model=<path>");
+    return;
+  }
+  const auto size_index = static_cast<std::size_t>(state.range(0));
+  const auto *images = GetImages(state, size_index);
+  if (images == nullptr) {
+    return;
+  }
+  const bool tiled = state.range(1) != 0;
+
+  LatencyRecorder latency;
+  std::size_t next = 0;
+  std::size_t boxes = 0;
+  for (auto _ : state) {
+    const auto &image = (*images)[next++ % images->size()];
+    latency.Start();
+    const auto detections = tiled ? detector->detectTiled(image) : detector->detect(image);
+    latency.Stop();
+    boxes += detections.size();
+  }
+  latency.Report(state);
+  state.SetItemsProcessed(state.iterations());
+  state.counters["boxes"] = benchmark::Counter(static_cast<double>(boxes), benchmark::Counter::kAvgIterations);
+  state.SetLabel(SizeLabel(size_index) + (tiled ? " tiled" : ""));
+}
+// A network must not run two forward passes at once, the detection is not benchmarked on several threads.
+BENCHMARK(BM_EastDetect)
+    ->ArgsProduct({{0, 1, 2}, {0, 1}})
+    ->ArgNames({"size", "tiled"})
+    ->Unit(benchmark::kMillisecond);
+
+/**
+ * @brief Recognizes one region of a frame. Arguments: number of characters of the region, frame size, recognition
+ * profile (0: default, 1: single line).
+ *
+ * @details The engine is only handed the region, so the time follows the number of characters, not the frame size.
+ */
+static auto BM_RecognizeText(benchmark::State &state) -> void {
+  const bool single_line = state.range(2) != 0;
+  std::unique_ptr<TesseractApi> tesseract;
+  try {
+    tesseract = std::make_unique<TesseractApi>(
+        "eng", single_line ? RecognitionProfile::SingleLine() : RecognitionProfile::Default());
+  } catch (const std::runtime_error &e) {
+    state.SkipWithError(e.what());
+    return;
+  }
+
+  const auto length = static_cast<std::size_t>(state.range(0));
+  const auto size_index = static_cast<std::size_t>(state.range(1));
+  std::string text;
+  for (const auto &word : GenerateWords(length, 3, 8, static_cast<unsigned>(length))) {
+    if (text.size() >= length) {
+      break;
+    }
+    text += (text.empty() ? "" : " ") + word;
+  }
+  text.resize(length);
+
+  cv::Mat frame(kImageSizes[size_index], CV_8UC1, cv::Scalar(255));
+  const auto box = RenderText(frame, text, {20, frame.rows / 2});
+  const cv::Rect roi = cv::Rect(box.x - 5, box.y - 5, box.width + 10, box.height + 10) &
+                       cv::Rect(0, 0, frame.cols, frame.rows);
+
+  LatencyRecorder latency;
+  for (auto _ : state) {
+    latency.Start();
+    benchmark::DoNotOptimize(RecognizeText(*tesseract, frame, 0, roi));
+    latency.Stop();
+  }
+  latency.Report(state);
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * roi.area());
+  state.SetLabel(fmt::format("roi {}x{} in {}{}", roi.width, roi.height, SizeLabel(size_index),
+                             single_line ? " single line" : ""));
+}
+BENCHMARK(BM_RecognizeText)
+    ->ArgsProduct({{4, 16, 48}, {0, 2}, {0, 1}})
+    ->ArgNames({"chars", "size", "line"})
+    ->Unit(benchmark::kMillisecond);
+// Every thread owns its engine, as the workers of a TesseractPool do.
+BENCHMARK(BM_RecognizeText)
+    ->Args({16, 1, 0})
+    ->ArgNames({"chars", "size", "line"})
+    ->ThreadRange(1, kMaxThreads)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+/**
+ * @brief Detects and reads a whole image. Argument: number of recognition threads, 0 for the single-thread path.
+ */
+static auto BM_DetectRead(benchmark::State &state) -> void {
+  const auto *detector = GetDetector();
+  if (detector == nullptr) {
+    state.SkipWithError("no EAST model, pass --model=<path>");
+    return;
+  }
+  const auto *images = GetImages(state, 1);
+  if (images == nullptr) {
+    return;
+  }
+
+  const auto num_threads = static_cast<std::size_t>(state.range(0));
+  TesseractPool tesseract_pool(std::max<std::size_t>(num_threads, 1));
+  try {
+    tesseract_pool.Warmup();
+  } catch (const std::runtime_error &e) {
+    state.SkipWithError(e.what());
+    return;
+  }
+  const auto thread_pool = num_threads > 0 ? std::make_unique<ThreadPool>(num_threads) : nullptr;
+
+  LatencyRecorder latency;
+  std::size_t next = 0;
+  std::size_t words = 0;
+  for (auto _ : state) {
+    const auto &image = (*images)[next++ % images->size()];
+    latency.Start();
+    const auto results = thread_pool != nullptr
+                             ? DetectReadTextMultiThread(image, *detector, tesseract_pool, *thread_pool)
+                             : DetectReadText(image, *detector, tesseract_pool);
+    latency.Stop();
+    words += results.size();
+  }
+  latency.Report(state);
+  state.SetItemsProcessed(state.iterations());
+  state.counters["words"] = benchmark::Counter(static_cast<double>(words), benchmark::Counter::kAvgIterations);
+  state.SetLabel(num_threads > 0 ? fmt::format("{} threads", num_threads) : "single thread");
+}
+BENCHMARK(BM_DetectRead)
+    ->Arg(0)
+    ->RangeMultiplier(2)
+    ->Range(1, kMaxThreads)
+    ->ArgName("threads")
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "checkpoint.hpp"
+#include "textspotter/utility.hpp"
+
+static auto Line(const std::string &path) -> std::string {
+  return "{\"path\":" + ToJsonString(path) + ",\"detections\":[]}\n";
+}
+
+TEST(CheckpointTest, ReadsCompleteLines) {
+  const auto output = Line("a.png") + Line("b.png");
+  std::istringstream in(output);
+  const auto checkpoint = ReadCheckpoint(in);
+  EXPECT_EQ(checkpoint.done_.size(), 2);
+  EXPECT_EQ(checkpoint.done_.count("a.png"), 1);
+  EXPECT_EQ(checkpoint.done_.count("b.png"), 1);
+  EXPECT_EQ(checkpoint.complete_size_, static_cast<std::streamoff>(output.size()));
+}
+
+TEST(CheckpointTest, IgnoresTruncatedLastLine) {
+  const auto complete = Line("a.png") + Line("b.png");
+  std::istringstream in(complete + "{\"path\":\"c.png\",\"detec");
+  const auto checkpoint = ReadCheckpoint(in);
+  EXPECT_EQ(checkpoint.done_.size(), 2);
+  EXPECT_EQ(checkpoint.done_.count("c.png"), 0);
+  EXPECT_EQ(checkpoint.complete_size_, static_cast<std::streamoff>(complete.size()));
+}
+
+TEST(CheckpointTest, IgnoresTruncatedPath) {
+  std::istringstream in(Line("a.png") + "{\"path\":\"b.p");
+  EXPECT_EQ(ReadCheckpoint(in).done_.size(), 1);
+}
+
+TEST(CheckpointTest, UnescapesPaths) {
+  const std::vector<std::string> paths = {"say \"hi\".png", "C:\\images\\a.png", "tab\there.png", "caf\xc3\xa9.png"};
+  std::string output;
+  for (const auto &path : paths) {
+    output += Line(path);
+  }
+  std::istringstream in(output);
+  const auto checkpoint = ReadCheckpoint(in);
+  ASSERT_EQ(checkpoint.done_.size(), paths.size());
+  for (const auto &path : paths) {
+    EXPECT_EQ(checkpoint.done_.count(path), 1) << path;
+  }
+}
+
+TEST(CheckpointTest, SkipsOtherLines) {
+  const auto output = std::string("\n") + "not json\n" + "{\"other\":\"a.png\"}\n" + Line("b.png");
+  std::istringstream in(output);
+  const auto checkpoint = ReadCheckpoint(in);
+  EXPECT_EQ(checkpoint.done_.size(), 1);
+  EXPECT_EQ(checkpoint.done_.count("b.png"), 1);
+  EXPECT_EQ(checkpoint.complete_size_, static_cast<std::streamoff>(output.size()));
+}
+
+TEST(CheckpointTest, EmptyOutput) {
+  std::istringstream in("");
+  const auto checkpoint = ReadCheckpoint(in);
+  EXPECT_TRUE(checkpoint.done_.empty());
+  EXPECT_EQ(checkpoint.complete_size_, 0);
+}
+
+TEST(CheckpointTest, RemovesDonePathsInOrder) {
+  std::istringstream in(Line("b.png") + Line("d.png") + Line("x.png"));
+  const auto checkpoint = ReadCheckpoint(in);
+  std::vector<std::string> paths = {"a.png", "b.png", "c.png", "d.png", "e.png"};
+  EXPECT_EQ(RemoveDonePaths(paths, checkpoint), 2);
+  EXPECT_EQ(paths, (std::vector<std::string>{"a.png", "c.png", "e.png"}));
+}
@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+
+#include <opencv2/opencv.hpp>
+
+#include "textspotter/box_merging.hpp"
+
+static auto MakeDetection(const cv::Rect &box, float conf = 0.9F) -> TextDetectionResult {
+  return {box, conf, cv::RotatedRect()};
+}
+
+TEST(MergeTextBoxesTest, WordsOfALineBecomeOneRegion) {
+  // Three words of a 20 pixel high line, 8 and 12 pixels apart.
+  const std::vector<TextDetectionResult> detections{MakeDetection({10, 100, 60, 20}, 0.7F),
+                                                    MakeDetection({78, 101, 40, 19}, 0.9F),
+                                                    MakeDetection({130, 100, 50, 20}, 0.8F)};
+
+  const auto regions = MergeTextBoxes(detections);
+  ASSERT_EQ(regions.size(), 1);
+  EXPECT_EQ(regions[0].bounding_box_, cv::Rect(10, 100, 170, 20));
+  EXPECT_FLOAT_EQ(regions[0].conf_, 0.9F);
+}
+
+TEST(MergeTextBoxesTest, DistantWordsStayApart) {
+  const std::vector<TextDetectionResult> detections{MakeDetection({10, 100, 60, 20}),
+                                                    MakeDetection({200, 100, 60, 20})};
+
+  const auto regions = MergeTextBoxes(detections);
+  ASSERT_EQ(regions.size(), 2);
+  EXPECT_EQ(regions[0].bounding_box_, detections[0].bounding_box_);
+  EXPECT_EQ(regions[1].bounding_box_, detections[1].bounding_box_);
+}
+
+TEST(MergeTextBoxesTest, NeighbouringLinesStayApart) {
+  // The lines are 4 pixels apart, their expanded regions overlap but they do not share a line.
+  const std::vector<TextDetectionResult> detections{MakeDetection({10, 100, 100, 20}),
+                                                    MakeDetection({10, 124, 100, 20})};
+
+  EXPECT_EQ(MergeTextBoxes(detections).size(), 2);
+}
+
+TEST(MergeTextBoxesTest, OverlappingBoxesAreMerged) {
+  // A box of a word detected twice, and a box of another size overlapping it.
+  const std::vector<TextDetectionResult> detections{MakeDetection({10, 10, 50, 20}), MakeDetection({12, 11, 50, 20}),
+                                                    MakeDetection({40, 0, 30, 60})};
+
+  const auto regions = MergeTextBoxes(detections);
+  ASSERT_EQ(regions.size(), 1);
+  EXPECT_EQ(regions[0].bounding_box_, cv::Rect(10, 0, 60, 60));
+}
+
+TEST(MergeTextBoxesTest, GrowingRegionReachesEarlierBoxes) {
+  // The first box only overlaps the region of the last two boxes once they are merged.
+  const std::vector<TextDetectionResult> detections{MakeDetection({32, 0, 10, 8}), MakeDetection({30, 30, 20, 20}),
+                                                    MakeDetection({45, 5, 20, 30}),
+                                                    MakeDetection({300, 300, 40, 20})};
+
+  const auto regions = MergeTextBoxes(detections);
+  ASSERT_EQ(regions.size(), 2);
+  EXPECT_EQ(regions[0].bounding_box_, cv::Rect(30, 0, 35, 50));
+  EXPECT_EQ(regions[1].bounding_box_, cv::Rect(300, 300, 40, 20));
+}
+
+TEST(MergeTextBoxesTest, SlantedBoxesAreKept) {
+  auto slanted = MakeDetection({70, 100, 40, 20});
+  slanted.rotated_box_ = cv::RotatedRect(cv::Point2f(90, 110), cv::Size2f(40, 10), 20.0F);
+  const std::vector<TextDetectionResult> detections{MakeDetection({10, 100, 50, 20}), slanted};
+
+  BoxMergeOptions options;
+  options.max_angle_ = 5.0F;
+  const auto regions = MergeTextBoxes(detections, options);
+  ASSERT_EQ(regions.size(), 2);
+  EXPECT_EQ(regions[1].rotated_box_.angle, 20.0F);
+
+  EXPECT_EQ(MergeTextBoxes(detections).size(), 1);
+}
+
+TEST(CalcIoUTest, Ratios) {
+  EXPECT_FLOAT_EQ(CalcIoU({0, 0, 10, 10}, {0, 0, 10, 10}), 1.0F);
+  EXPECT_FLOAT_EQ(CalcIoU({0, 0, 10, 10}, {5, 0, 10, 10}), 50.0F / 150.0F);
+  EXPECT_FLOAT_EQ(CalcIoU({0, 0, 10, 10}, {20, 20, 10, 10}), 0.0F);
+  EXPECT_FLOAT_EQ(CalcIoU({}, {}), 0.0F);
+}
+
+TEST(SuppressDuplicateResultsTest, KeepsTheMostConfidentReading) {
+  std::vector<DetectReadResult> results{{"Settings", {10, 10, 80, 20}, 71.0F},
+                                        {"Cancel", {200, 10, 60, 20}, 90.0F},
+                                        {"Settinqs", {11, 10, 80, 21}, 65.0F},
+                                        {"Setting5", {9, 10, 80, 20}, 88.0F}};
+
+  EXPECT_EQ(SuppressDuplicateResults(results), 2);
+  ASSERT_EQ(results.size(), 2);
+  EXPECT_EQ(results[0].text_, "Cancel");
+  EXPECT_EQ(results[1].text_, "Setting5");
+}
+
+TEST(SuppressDuplicateResultsTest, NeighbouringWordsAreKept) {
+  std::vector<DetectReadResult> results{{"OK", {10, 10, 30, 20}, 90.0F}, {"Cancel", {35, 10, 60, 20}, 90.0F}};
+
+  EXPECT_EQ(SuppressDuplicateResults(results), 0);
+  EXPECT_EQ(results.size(), 2);
+}
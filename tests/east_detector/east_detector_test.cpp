@@ -0,0 +1,87 @@
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+#include <vector>
+
+#include "synthetic_east.hpp"
+#include "textspotter/east_detector.hpp"
+
+static auto MakeFrame(const cv::Size &size, const cv::Rect &text) -> cv::Mat {
+  cv::Mat frame(size, CV_8UC3, cv::Scalar::all(0));
+  frame(text).setTo(cv::Scalar::all(255));
+  return frame;
+}
+
+static auto ExpectSameDetections(const std::vector<TextDetectionResult> &actual,
+                                 const std::vector<TextDetectionResult> &expected) -> void {
+  ASSERT_EQ(actual.size(), expected.size());
+  for (std::size_t i = 0; i < actual.size(); ++i) {
+    EXPECT_EQ(actual[i].bounding_box_, expected[i].bounding_box_);
+    EXPECT_NEAR(actual[i].conf_, expected[i].conf_, 1e-4);
+    EXPECT_NEAR(actual[i].rotated_box_.center.x, expected[i].rotated_box_.center.x, 1e-3);
+    EXPECT_NEAR(actual[i].rotated_box_.center.y, expected[i].rotated_box_.center.y, 1e-3);
+    EXPECT_NEAR(actual[i].rotated_box_.size.width, expected[i].rotated_box_.size.width, 1e-3);
+    EXPECT_NEAR(actual[i].rotated_box_.size.height, expected[i].rotated_box_.size.height, 1e-3);
+    EXPECT_NEAR(actual[i].rotated_box_.angle, expected[i].rotated_box_.angle, 1e-3);
+  }
+}
+
+TEST(DetectBatchTest, MatchesDetectPerFrame) {
+  const EastTextDetector detector(MakeSyntheticEast());
+  // Frames of different sizes, so each one is mapped back with its own ratio.
+  const std::vector<cv::Mat> frames{
+      MakeFrame({640, 320}, {100, 40, 60, 16}),
+      MakeFrame({320, 160}, {20, 100, 40, 12}),
+      MakeFrame({1280, 480}, {900, 200, 120, 24}),
+  };
+
+  const auto batch = detector.detectBatch(frames);
+  ASSERT_EQ(batch.size(), frames.size());
+  for (std::size_t i = 0; i < frames.size(); ++i) {
+    SCOPED_TRACE(i);
+    const auto single = detector.detect(frames[i]);
+    EXPECT_FALSE(single.empty());
+    ExpectSameDetections(batch[i], single);
+  }
+}
+
+TEST(DetectBatchTest, EmptyFramesKeepTheirSlot) {
+  const EastTextDetector detector(MakeSyntheticEast());
+  const cv::Mat frame = MakeFrame({640, 320}, {300, 150, 80, 20});
+
+  const auto batch = detector.detectBatch({cv::Mat(), frame, cv::Mat()});
+  ASSERT_EQ(batch.size(), 3U);
+  EXPECT_TRUE(batch[0].empty());
+  EXPECT_TRUE(batch[2].empty());
+  EXPECT_FALSE(batch[1].empty());
+  ExpectSameDetections(batch[1], detector.detect(frame));
+
+  const auto all_empty = detector.detectBatch({cv::Mat(), cv::Mat()});
+  ASSERT_EQ(all_empty.size(), 2U);
+  EXPECT_TRUE(all_empty[0].empty());
+  EXPECT_TRUE(all_empty[1].empty());
+}
+
+TEST(DetectTest, ConvertsGrayAndBgraToBgr) {
+  const EastTextDetector detector(MakeSyntheticEast());
+  const cv::Mat bgr = MakeFrame({640, 320}, {200, 100, 80, 20});
+  cv::Mat gray;
+  cv::cvtColor(bgr, gray, cv::COLOR_BGR2GRAY);
+  cv::Mat bgra;
+  cv::cvtColor(bgr, bgra, cv::COLOR_BGR2BGRA);
+
+  const auto expected = detector.detect(bgr);
+  ASSERT_FALSE(expected.empty());
+  ExpectSameDetections(detector.detect(gray), expected);
+  ExpectSameDetections(detector.detect(bgra), expected);
+
+  const auto batch = detector.detectBatch({gray, bgra});
+  ASSERT_EQ(batch.size(), 2U);
+  ExpectSameDetections(batch[0], expected);
+  ExpectSameDetections(batch[1], expected);
+
+  // Other layouts are not guessed.
+  EXPECT_TRUE(detector.detect(cv::Mat(320, 640, CV_8UC2, cv::Scalar::all(255))).empty());
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <memory>
+#include <opencv2/dnn.hpp>
+#include <vector>
+
+/**
+ * @brief Builds a stand-in for the EAST graph, with the same output names: cells of 4x4 bright pixels score high and
+ * every box is 8 pixels wide and high.
+ */
+inline auto MakeSyntheticEast() -> std::unique_ptr<cv::dnn::TextDetectionModel_EAST> {
+  cv::dnn::Net net;
+
+  // The model takes the first unconnected output as the geometry, so it is added first.
+  cv::dnn::LayerParams geometry;
+  geometry.set("kernel_size", 4);
+  geometry.set("stride", 4);
+  geometry.set("num_output", 5);
+  geometry.set("bias_term", true);
+  geometry.blobs.emplace_back(std::vector<int>{5, 3, 4, 4}, CV_32F, cv::Scalar(0));
+  // Distances to the top, right, bottom and left edges, then the angle.
+  cv::Mat geometry_bias(1, 5, CV_32F, cv::Scalar(4));
+  geometry_bias.at<float>(0, 4) = 0;
+  geometry.blobs.push_back(geometry_bias);
+  const int geometry_id = net.addLayer("feature_fusion/concat_3", "Convolution", geometry);
+  net.connect(0, 0, geometry_id, 0);
+
+  // Mean of the cell after the mean subtraction, positive on bright pixels.
+  cv::dnn::LayerParams score;
+  score.set("kernel_size", 4);
+  score.set("stride", 4);
+  score.set("num_output", 1);
+  score.set("bias_term", true);
+  score.blobs.emplace_back(std::vector<int>{1, 3, 4, 4}, CV_32F, cv::Scalar(1.0 / 48.0));
+  score.blobs.emplace_back(1, 1, CV_32F, cv::Scalar(0));
+  const int score_id = net.addLayer("feature_fusion/Conv_7", "Convolution", score);
+  net.connect(0, 0, score_id, 0);
+
+  cv::dnn::LayerParams sigmoid;
+  const int sigmoid_id = net.addLayer("feature_fusion/Conv_7/Sigmoid", "Sigmoid", sigmoid);
+  net.connect(score_id, 0, sigmoid_id, 0);
+
+  auto model = std::make_unique<cv::dnn::TextDetectionModel_EAST>(net);
+  model->setConfidenceThreshold(0.5F);
+  model->setNMSThreshold(0.4F);
+  // The input parameters EastTextDetector assumes for a model it did not configure.
+  model->setInputParams(1.0, cv::Size(640, 320), cv::Scalar(123.68, 116.78, 103.94), true);
+  return model;
+}
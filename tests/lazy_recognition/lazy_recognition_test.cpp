@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "textspotter/lazy_recognition.hpp"
+
+class LazyRecognizerTest : public ::testing::Test {
+ protected:
+  const cv::Size image_size{640, 480};
+  std::vector<DetectReadResult> screen;  // The words the reader finds, one per region.
+  std::vector<cv::Rect> read_boxes;      // The regions handed to the reader, in order.
+  int num_batches = 0;
+
+  void SetUp() override {
+    screen = {
+        {"Settings and more", {0, 0, 400, 20}},
+        {"OK", {0, 100, 20, 20}},
+        {"Cancel", {300, 300, 60, 20}},
+    };
+  }
+
+  auto Regions() const -> std::vector<TextDetectionResult> {
+    std::vector<TextDetectionResult> regions;
+    for (const auto &word : screen) {
+      regions.push_back({word.bounding_box_, 1.0F, {}});
+    }
+    return regions;
+  }
+
+  auto Reader() -> LazyRecognizer::Reader {
+    return [this](const std::vector<TextDetectionResult> &regions) {
+      ++num_batches;
+      std::vector<DetectReadResult> words;
+      for (const auto &region : regions) {
+        read_boxes.push_back(region.bounding_box_);
+        for (const auto &word : screen) {
+          if (word.bounding_box_ == region.bounding_box_) {
+            words.push_back(word);
+          }
+        }
+      }
+      return words;
+    };
+  }
+};
+
+TEST(RankRegionTest, PrefersRegionsFittingTheTarget) {
+  // A target of 6 characters in a region 20 pixels high is expected to be about 60 pixels wide.
+  const double fitting = RankRegion({0, 0, 60, 20}, 6, {-1, -1}, 100.0);
+  const double wider = RankRegion({0, 0, 120, 20}, 6, {-1, -1}, 100.0);
+  const double narrower = RankRegion({0, 0, 30, 20}, 6, {-1, -1}, 100.0);
+  EXPECT_DOUBLE_EQ(fitting, 0.0);
+  EXPECT_LT(fitting, wider);
+  EXPECT_LT(wider, narrower);
+}
+
+TEST(RankRegionTest, PreviousMatchBreaksTies) {
+  const cv::Point last_hit(100, 100);
+  const double close = RankRegion({80, 90, 60, 20}, 6, last_hit, 800.0);
+  const double far = RankRegion({500, 400, 60, 20}, 6, last_hit, 800.0);
+  EXPECT_LT(close, far);
+  EXPECT_DOUBLE_EQ(RankRegion({500, 400, 60, 20}, 6, {-1, -1}, 800.0), 0.0);
+}
+
+TEST_F(LazyRecognizerTest, StopsAtFirstGoodMatch) {
+  LazyRecognizer recognizer;
+  recognizer.Reset(Regions());
+  const auto match = recognizer.Match("Cancel", image_size, 1, 0.8F, Reader());
+
+  EXPECT_EQ(match.point_, cv::Point(330, 310));
+  EXPECT_EQ(recognizer.NumReadRegions(), 1);
+  EXPECT_EQ(read_boxes, std::vector<cv::Rect>{screen[2].bounding_box_});
+
+  // The next query starts from the words already read, and only reads what it still needs.
+  EXPECT_EQ(recognizer.Match("Cancel", image_size, 1, 0.8F, Reader()).point_, cv::Point(330, 310));
+  EXPECT_EQ(num_batches, 1);
+  EXPECT_EQ(recognizer.Match("OK", image_size, 1, 0.8F, Reader()).point_, cv::Point(10, 110));
+  EXPECT_EQ(recognizer.NumReadRegions(), 2);
+  EXPECT_EQ(read_boxes.back(), screen[1].bounding_box_);
+}
+
+TEST_F(LazyRecognizerTest, ReadsEveryRegionForMissingTarget) {
+  LazyRecognizer recognizer;
+  recognizer.Reset(Regions());
+  const auto match = recognizer.Match("Apply", image_size, 2, 0.8F, Reader());
+
+  EXPECT_EQ(match.point_, cv::Point(-1, -1));
+  EXPECT_EQ(recognizer.NumReadRegions(), 3);
+  EXPECT_EQ(num_batches, 2);
+
+  recognizer.ReadAll(Reader());
+  EXPECT_EQ(num_batches, 2);
+  EXPECT_EQ(recognizer.GetResults().size(), 3);
+}
+
+TEST_F(LazyRecognizerTest, ResetDiscardsPreviousRegions) {
+  LazyRecognizer recognizer;
+  recognizer.Reset(Regions());
+  recognizer.ReadAll(Reader());
+  ASSERT_EQ(recognizer.GetResults().size(), 3);
+
+  screen = {{"Apply", {100, 200, 50, 20}}};
+  recognizer.Reset(Regions());
+  EXPECT_TRUE(recognizer.GetResults().empty());
+  EXPECT_EQ(recognizer.NumRegions(), 1);
+  EXPECT_EQ(recognizer.NumReadRegions(), 0);
+
+  read_boxes.clear();
+  EXPECT_EQ(recognizer.Match("Cancel", image_size, 1, 0.8F, Reader()).point_, cv::Point(-1, -1));
+  EXPECT_EQ(read_boxes, std::vector<cv::Rect>{screen[0].bounding_box_});
+  EXPECT_EQ(recognizer.Match("Apply", image_size, 1, 0.8F, Reader()).point_, cv::Point(125, 210));
+}
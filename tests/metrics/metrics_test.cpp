@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "textspotter/metrics.hpp"
+
+TEST(HistogramTest, SummaryAndQuantiles) {
+  Histogram histogram;
+  EXPECT_EQ(histogram.GetCount(), 0);
+  EXPECT_DOUBLE_EQ(histogram.GetQuantile(0.5), 0.0);
+
+  for (int i = 1; i <= 100; ++i) {
+    histogram.Record(i * 1e-3);
+  }
+  EXPECT_EQ(histogram.GetCount(), 100);
+  EXPECT_NEAR(histogram.GetSum(), 5.05, 1e-9);
+  EXPECT_DOUBLE_EQ(histogram.GetMin(), 1e-3);
+  EXPECT_DOUBLE_EQ(histogram.GetMax(), 0.1);
+  EXPECT_NEAR(histogram.GetMean(), 0.0505, 1e-9);
+
+  // Quantiles are accurate to the width of a bucket, a factor of 2.
+  const double median = histogram.GetQuantile(0.5);
+  EXPECT_GT(median, 0.025);
+  EXPECT_LT(median, 0.1);
+  EXPECT_DOUBLE_EQ(histogram.GetQuantile(0.0), 1e-3);
+  EXPECT_DOUBLE_EQ(histogram.GetQuantile(1.0), 0.1);
+  EXPECT_LE(histogram.GetQuantile(0.5), histogram.GetQuantile(0.9));
+}
+
+TEST(HistogramTest, BucketsCoverEveryDuration) {
+  Histogram histogram;
+  histogram.Record(-1.0);
+  histogram.Record(1e-6);
+  histogram.Record(1e3);
+
+  const auto &buckets = histogram.GetBuckets();
+  EXPECT_EQ(buckets.front(), 2);
+  EXPECT_EQ(buckets.back(), 1);
+  EXPECT_DOUBLE_EQ(Histogram::GetBucketBound(0), 1e-5);
+  EXPECT_DOUBLE_EQ(Histogram::GetBucketBound(1), 2e-5);
+  EXPECT_GT(Histogram::GetBucketBound(Histogram::kNumBuckets - 1), 1e300);
+}
+
+TEST(MetricsTest, RecordAndIncrement) {
+  Metrics metrics;
+  EXPECT_EQ(metrics.GetCounter(kCounterBoxes), 0);
+  EXPECT_EQ(metrics.GetHistogram(kStageOcr).GetCount(), 0);
+
+  metrics.Increment(kCounterBoxes, 3);
+  metrics.Increment(kCounterBoxes);
+  metrics.Record(kStageOcr, 0.5);
+  {
+    const StageTimer timer(&metrics, kStageMatch);
+  }
+  {
+    // A timer without metrics does nothing.
+    const StageTimer timer(nullptr, kStageMatch);
+  }
+
+  EXPECT_EQ(metrics.GetCounter(kCounterBoxes), 4);
+  EXPECT_EQ(metrics.GetHistogram(kStageOcr).GetCount(), 1);
+  EXPECT_EQ(metrics.GetHistogram(kStageMatch).GetCount(), 1);
+  ASSERT_EQ(metrics.GetHistograms().size(), 2);
+  EXPECT_EQ(metrics.GetHistograms()[0].first, "match");
+  ASSERT_EQ(metrics.GetCounters().size(), 1);
+
+  metrics.Reset();
+  EXPECT_TRUE(metrics.GetHistograms().empty());
+  EXPECT_TRUE(metrics.GetCounters().empty());
+}
+
+TEST(MetricsTest, ConcurrentRecording) {
+  Metrics metrics;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&metrics] {
+      for (int i = 0; i < 1000; ++i) {
+        metrics.Record(kStageOcr, 1e-4);
+        metrics.Increment(kCounterWords);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(metrics.GetHistogram(kStageOcr).GetCount(), 4000);
+  EXPECT_EQ(metrics.GetCounter(kCounterWords), 4000);
+}
+
+TEST(MetricsTest, ExportJson) {
+  Metrics metrics;
+  metrics.Increment(kCounterWords, 7);
+  metrics.Record(kStageOcr, 0.25);
+
+  const auto json = metrics.Export(MetricsFormat::kJson);
+  EXPECT_NE(json.find("\"counters\":{\"words\":7}"), std::string::npos);
+  EXPECT_NE(json.find("\"ocr\":{\"count\":1,\"sum\":0.25"), std::string::npos);
+  EXPECT_NE(json.find("\"buckets\":[{\"le\":0.32768,\"count\":1}]"), std::string::npos);
+}
+
+TEST(MetricsTest, ExportPrometheus) {
+  Metrics metrics;
+  metrics.Increment("ocr cache-hits", 2);
+  metrics.Record(kStageDetect, 0.25);
+  metrics.Record(kStageDetect, 100.0);
+
+  const auto text = metrics.Export(MetricsFormat::kPrometheus);
+  EXPECT_NE(text.find("# TYPE textspotter_ocr_cache_hits_total counter\ntextspotter_ocr_cache_hits_total 2\n"),
+            std::string::npos);
+  EXPECT_NE(text.find("# TYPE textspotter_detect_seconds histogram\n"), std::string::npos);
+  EXPECT_NE(text.find("textspotter_detect_seconds_bucket{le=\"1e-05\"} 0\n"), std::string::npos);
+  EXPECT_NE(text.find("textspotter_detect_seconds_bucket{le=\"0.32768\"} 1\n"), std::string::npos);
+  EXPECT_NE(text.find("textspotter_detect_seconds_bucket{le=\"+Inf\"} 2\n"), std::string::npos);
+  EXPECT_NE(text.find("textspotter_detect_seconds_sum 100.25\ntextspotter_detect_seconds_count 2\n"),
+            std::string::npos);
+}
+
+TEST(MetricsTest, Save) {
+  const std::string path = std::string(std::tmpnam(nullptr)) + ".prom";
+  Metrics metrics;
+  metrics.Increment(kCounterImages);
+  ASSERT_TRUE(metrics.Save(path, MetricsFormat::kPrometheus));
+
+  std::ifstream in(path);
+  std::stringstream content;
+  content << in.rdbuf();
+  EXPECT_EQ(content.str(), metrics.Export(MetricsFormat::kPrometheus));
+  std::remove(path.c_str());
+}
@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <opencv2/opencv.hpp>
+
+#include "textspotter/ocr_cache.hpp"
+
+static auto MakeResults(const std::string &text) -> std::vector<OcrResult> { return {{text, {1, 2, 30, 10}, 91.5F}}; }
+
+TEST(OcrCacheTest, MissThenHit) {
+  OcrCache cache;
+  EXPECT_FALSE(cache.Find(42).has_value());
+
+  cache.Insert(42, MakeResults("OK"));
+  const auto found = cache.Find(42);
+  ASSERT_TRUE(found.has_value());
+  ASSERT_EQ(found->size(), 1);
+  EXPECT_EQ((*found)[0].text_, "OK");
+  EXPECT_EQ((*found)[0].bounding_box_, cv::Rect(1, 2, 30, 10));
+
+  EXPECT_EQ(cache.GetHits(), 1);
+  EXPECT_EQ(cache.GetMisses(), 1);
+}
+
+TEST(OcrCacheTest, EvictsLeastRecentlyUsed) {
+  OcrCache cache(1);
+  cache.Insert(1, MakeResults("first"));
+  cache.Insert(2, MakeResults("second"));
+
+  // Every entry exceeds the budget on its own.
+  EXPECT_EQ(cache.Size(), 0);
+
+  OcrCache larger(100000);
+  for (std::uint64_t key = 0; key < 10000; ++key) {
+    larger.Insert(key, MakeResults("label"));
+    larger.Find(0);
+  }
+  EXPECT_LE(larger.GetMemoryUsage(), 100000);
+  EXPECT_TRUE(larger.Find(0).has_value());
+  EXPECT_FALSE(larger.Find(1).has_value());
+}
+
+TEST(OcrCacheTest, SaveAndLoad) {
+  const std::string path = std::string(std::tmpnam(nullptr)) + ".ocrcache";
+
+  OcrCache cache;
+  cache.Insert(7, MakeResults("Settings"));
+  cache.Insert(8, {});
+  ASSERT_TRUE(cache.Save(path));
+
+  OcrCache loaded;
+  ASSERT_TRUE(loaded.Load(path));
+  EXPECT_EQ(loaded.Size(), 2);
+  const auto found = loaded.Find(7);
+  ASSERT_TRUE(found.has_value());
+  EXPECT_EQ((*found)[0].text_, "Settings");
+  EXPECT_FLOAT_EQ((*found)[0].conf_, 91.5F);
+
+  std::remove(path.c_str());
+  EXPECT_FALSE(loaded.Load(path));
+}
+
+TEST(OcrCacheTest, KeyDependsOnPixelsNotPosition) {
+  cv::Mat image(100, 100, CV_8UC1, cv::Scalar(0));
+  cv::putText(image, "A", {5, 30}, cv::FONT_HERSHEY_SIMPLEX, 1.0, {255}, 2);
+  image(cv::Rect(0, 0, 40, 40)).copyTo(image(cv::Rect(50, 50, 40, 40)));
+
+  const auto first = OcrCache::MakeKey(image(cv::Rect(0, 0, 40, 40)), 0);
+  const auto moved = OcrCache::MakeKey(image(cv::Rect(50, 50, 40, 40)), 0);
+  const auto other = OcrCache::MakeKey(image(cv::Rect(10, 0, 40, 40)), 0);
+  const auto other_config = OcrCache::MakeKey(image(cv::Rect(0, 0, 40, 40)), 1);
+
+  EXPECT_EQ(first, moved);
+  EXPECT_NE(first, other);
+  EXPECT_NE(first, other_config);
+}
@@ -0,0 +1,44 @@
+#include <gtest/gtest.h>
+
+#include "textspotter/ocr.hpp"
+
+TEST(RecognitionProfileTest, DefaultKeepsTheEngineDefaults) {
+  const auto profile = RecognitionProfile::Default();
+  EXPECT_EQ(profile.page_seg_mode_, tesseract::PSM_SINGLE_BLOCK);
+  EXPECT_EQ(profile.engine_mode_, tesseract::OEM_DEFAULT);
+  EXPECT_TRUE(profile.load_dictionaries_);
+  EXPECT_TRUE(profile.char_whitelist_.empty());
+}
+
+TEST(RecognitionProfileTest, PresetsSkipTheLayoutAnalysis) {
+  EXPECT_EQ(RecognitionProfile::SingleLine().page_seg_mode_, tesseract::PSM_SINGLE_LINE);
+  EXPECT_EQ(RecognitionProfile::SingleWord().page_seg_mode_, tesseract::PSM_SINGLE_WORD);
+  EXPECT_EQ(RecognitionProfile::RawLine().page_seg_mode_, tesseract::PSM_RAW_LINE);
+  EXPECT_EQ(RecognitionProfile::SingleLine().engine_mode_, tesseract::OEM_LSTM_ONLY);
+  EXPECT_FALSE(RecognitionProfile::RawLine().load_dictionaries_);
+}
+
+TEST(RecognitionProfileTest, KeyFollowsEverySetting) {
+  const auto base = RecognitionProfile::SingleLine();
+  EXPECT_EQ(base.GetKey(), RecognitionProfile::SingleLine().GetKey());
+  EXPECT_NE(base.GetKey(), RecognitionProfile::Default().GetKey());
+  EXPECT_NE(base.GetKey(), RecognitionProfile::SingleWord().GetKey());
+  EXPECT_NE(base.GetKey(), RecognitionProfile::RawLine().GetKey());
+
+  auto no_dictionary = base;
+  no_dictionary.load_dictionaries_ = false;
+  EXPECT_NE(base.GetKey(), no_dictionary.GetKey());
+
+  auto digits = base;
+  digits.char_whitelist_ = "0123456789";
+  auto hex = base;
+  hex.char_whitelist_ = "0123456789abcdef";
+  EXPECT_NE(base.GetKey(), digits.GetKey());
+  EXPECT_NE(digits.GetKey(), hex.GetKey());
+}
+
+TEST(RecognitionProfileTest, PoolKeepsLanguageAndProfile) {
+  const TesseractPool pool(2, "deu", RecognitionProfile::SingleWord());
+  EXPECT_EQ(pool.GetLanguage(), "deu");
+  EXPECT_EQ(pool.GetRecognitionProfile().GetKey(), RecognitionProfile::SingleWord().GetKey());
+}
@@ -0,0 +1,46 @@
+#include <gtest/gtest.h>
+
+#include <opencv2/opencv.hpp>
+
+#include "textspotter/preprocess.hpp"
+#include "textspotter/utility.hpp"
+
+class LazyPreprocessorTest : public ::testing::Test {
+ protected:
+  cv::Mat image;
+
+  void SetUp() override {
+    image = cv::Mat(300, 400, CV_8UC3, cv::Scalar(255, 255, 255));
+    cv::putText(image, "Hello World", {20, 80}, cv::FONT_HERSHEY_SIMPLEX, 1.5, {0, 0, 0}, 2);
+    cv::putText(image, "TextSpotter", {150, 250}, cv::FONT_HERSHEY_SIMPLEX, 1.0, {40, 40, 40}, 2);
+  }
+};
+
+TEST_F(LazyPreprocessorTest, MatchesFullPreprocessing) {
+  const cv::Mat full = Preprocess(image);
+  LazyPreprocessor lazy(image, 64);
+
+  for (const auto &roi : {cv::Rect(10, 40, 250, 60), cv::Rect(140, 210, 200, 60), cv::Rect(0, 0, 400, 300)}) {
+    const cv::Mat prepared = lazy.Prepare(roi);
+    ASSERT_EQ(prepared.size(), roi.size());
+    EXPECT_EQ(cv::norm(prepared, full(roi), cv::NORM_INF), 0);
+  }
+}
+
+TEST_F(LazyPreprocessorTest, OnlyProcessesOverlappingTiles) {
+  LazyPreprocessor lazy(image, 100);
+  EXPECT_EQ(lazy.NumProcessedTiles(), 0);
+
+  lazy.Prepare({10, 10, 20, 20});
+  EXPECT_EQ(lazy.NumProcessedTiles(), 1);
+
+  // Overlaps the tile already processed and the one on its right.
+  lazy.Prepare({90, 10, 20, 20});
+  EXPECT_EQ(lazy.NumProcessedTiles(), 2);
+}
+
+TEST_F(LazyPreprocessorTest, ClipsRegionToImage) {
+  LazyPreprocessor lazy(image);
+  EXPECT_TRUE(lazy.Prepare({500, 500, 10, 10}).empty());
+  EXPECT_EQ(lazy.Prepare({-10, -10, 30, 30}).size(), cv::Size(20, 20));
+}
@@ -0,0 +1,78 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <opencv2/opencv.hpp>
+
+#include "textspotter/preprocess.hpp"
+#include "textspotter/utility.hpp"
+
+class PreprocessPipelineTest : public ::testing::Test {
+ protected:
+  cv::Mat image;
+
+  void SetUp() override {
+    image = cv::Mat(120, 300, CV_8UC3, cv::Scalar(255, 255, 255));
+    cv::putText(image, "Pipeline", {10, 80}, cv::FONT_HERSHEY_SIMPLEX, 1.5, {0, 0, 0}, 2);
+  }
+};
+
+TEST_F(PreprocessPipelineTest, EmptyPipelineReturnsInput) {
+  const PreprocessPipeline pipeline;
+  const cv::Mat result = pipeline.Run(image);
+  EXPECT_EQ(cv::norm(result, image, cv::NORM_INF), 0);
+}
+
+TEST_F(PreprocessPipelineTest, DefaultProfileMatchesPreprocess) {
+  const auto pipeline = PreprocessPipeline::Default();
+  EXPECT_EQ(cv::norm(pipeline.Run(image), Preprocess(image), cv::NORM_INF), 0);
+}
+
+TEST_F(PreprocessPipelineTest, FastProfileSkipsDenoising) {
+  const auto names = PreprocessPipeline::Fast().GetStageNames();
+  EXPECT_EQ(std::find(names.begin(), names.end(), "nl_means_denoise"), names.end());
+
+  const cv::Mat result = PreprocessPipeline::Fast().Run(image);
+  EXPECT_EQ(result.size(), image.size());
+  EXPECT_EQ(result.channels(), 1);
+}
+
+TEST_F(PreprocessPipelineTest, RemoveStage) {
+  auto pipeline = PreprocessPipeline::Default();
+  EXPECT_TRUE(pipeline.RemoveStage("nl_means_denoise"));
+  EXPECT_FALSE(pipeline.RemoveStage("nl_means_denoise"));
+  EXPECT_EQ(pipeline.GetStageNames(),
+            (std::vector<std::string>{"grayscale", "invert", "gaussian_blur", "adaptive_threshold"}));
+}
+
+TEST_F(PreprocessPipelineTest, AccumulatesStageTimings) {
+  PreprocessPipeline pipeline;
+  pipeline.AddStage("grayscale", PreprocessPipeline::Grayscale()).AddStage("invert", PreprocessPipeline::Invert());
+
+  pipeline.Run(image);
+  pipeline.Run(image);
+
+  const auto timings = pipeline.GetStageTimings();
+  ASSERT_EQ(timings.size(), 2);
+  EXPECT_EQ(timings[0].name_, "grayscale");
+  EXPECT_EQ(timings[0].calls_, 2);
+  EXPECT_EQ(timings[1].calls_, 2);
+  EXPECT_GE(timings[1].total_seconds_, 0.0);
+
+  pipeline.ResetStageTimings();
+  EXPECT_EQ(pipeline.GetStageTimings()[0].calls_, 0);
+}
+
+TEST_F(PreprocessPipelineTest, MovedFromPipelineStaysUsable) {
+  auto pipeline = PreprocessPipeline::Default();
+  pipeline.Run(image);
+  PreprocessPipeline moved(std::move(pipeline));
+  EXPECT_EQ(moved.GetStageTimings()[0].calls_, 1);
+
+  // NOLINTNEXTLINE(bugprone-use-after-move)
+  EXPECT_TRUE(pipeline.GetStageTimings().empty());
+  EXPECT_EQ(cv::norm(pipeline.Run(image), image, cv::NORM_INF), 0);
+
+  pipeline = std::move(moved);
+  EXPECT_EQ(pipeline.GetStageNames().size(), 5);
+  EXPECT_TRUE(moved.GetStageNames().empty());
+}
@@ -0,0 +1,63 @@
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+#include "textspotter/bounded_queue.hpp"
+
+TEST(BoundedQueueTest, FirstInFirstOut) {
+  BoundedQueue<int> queue(3);
+  EXPECT_TRUE(queue.Push(1));
+  EXPECT_TRUE(queue.Push(2));
+  EXPECT_EQ(queue.Size(), 2);
+  EXPECT_EQ(queue.Pop(), 1);
+  EXPECT_EQ(queue.Pop(), 2);
+}
+
+TEST(BoundedQueueTest, PushOrDropDropsOldest) {
+  BoundedQueue<int> queue(2);
+  EXPECT_FALSE(queue.PushOrDrop(1));
+  EXPECT_FALSE(queue.PushOrDrop(2));
+  EXPECT_TRUE(queue.PushOrDrop(3));
+  EXPECT_EQ(queue.Size(), 2);
+  EXPECT_EQ(queue.Pop(), 2);
+  EXPECT_EQ(queue.Pop(), 3);
+}
+
+TEST(BoundedQueueTest, CloseDrainsRemainingItems) {
+  BoundedQueue<int> queue(2);
+  queue.Push(1);
+  queue.Close();
+  EXPECT_FALSE(queue.Push(2));
+  EXPECT_EQ(queue.Pop(), 1);
+  EXPECT_EQ(queue.Pop(), std::nullopt);
+}
+
+TEST(BoundedQueueTest, CancelDiscardsRemainingItems) {
+  BoundedQueue<int> queue(2);
+  queue.Push(1);
+  queue.Cancel();
+  EXPECT_EQ(queue.Pop(), std::nullopt);
+}
+
+TEST(BoundedQueueTest, ProducerWaitsForConsumer) {
+  BoundedQueue<int> queue(1);
+  constexpr int kNumItems = 1000;
+  std::thread producer([&queue]() {
+    for (int i = 0; i < kNumItems; ++i) {
+      queue.Push(i);
+    }
+    queue.Close();
+  });
+
+  std::vector<int> received;
+  while (auto item = queue.Pop()) {
+    received.push_back(*item);
+  }
+  producer.join();
+
+  ASSERT_EQ(received.size(), kNumItems);
+  for (int i = 0; i < kNumItems; ++i) {
+    EXPECT_EQ(received[i], i);
+  }
+}
@@ -0,0 +1,26 @@
+#include <gtest/gtest.h>
+
+#include <opencv2/opencv.hpp>
+
+#include "textspotter/textspotter_stream.hpp"
+
+TEST(SyntheticVideoTest, ProducesRequestedFrames) {
+  auto source = TextSpotterStream::SyntheticVideo(3, {320, 240});
+  cv::Mat previous;
+  cv::Mat frame;
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_TRUE(source(frame));
+    EXPECT_EQ(frame.size(), cv::Size(320, 240));
+    EXPECT_EQ(frame.type(), CV_8UC3);
+    if (!previous.empty()) {
+      // The text moves from one frame to the next.
+      EXPECT_GT(cv::norm(frame, previous, cv::NORM_L1), 0);
+    }
+    previous = frame.clone();
+  }
+  EXPECT_FALSE(source(frame));
+}
+
+TEST(SyntheticVideoTest, OpenVideoThrowsOnMissingFile) {
+  EXPECT_THROW(TextSpotterStream::OpenVideo("missing_video_file.avi"), std::runtime_error);
+}
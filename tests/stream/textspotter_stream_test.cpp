@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <future>
+#include <opencv2/core.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "textspotter/textspotter_stream.hpp"
+
+/**
+ * @brief Frames holding their own index, so that the results can be checked against the frame they come from.
+ */
+static auto CountingSource(int num_frames) -> TextSpotterStream::FrameSource {
+  return [num_frames, index = 0](cv::Mat &frame) mutable {
+    if (num_frames >= 0 && index >= num_frames) {
+      return false;
+    }
+    frame = cv::Mat(1, 1, CV_32S, cv::Scalar(index++));
+    return true;
+  };
+}
+
+/**
+ * @brief Replaces EAST and Tesseract: one region per frame, read as the index of the frame.
+ */
+static auto SetFakeStages(TextSpotterStream &stream, std::chrono::milliseconds read_time) -> void {
+  stream.SetDetectStage([](const cv::Mat &) { return std::vector<TextDetectionResult>{{{0, 0, 1, 1}, 1.0F, {}}}; });
+  stream.SetReadStage([read_time](const cv::Mat &frame, const std::vector<TextDetectionResult> &regions) {
+    std::this_thread::sleep_for(read_time);
+    return std::vector<DetectReadResult>{{std::to_string(frame.at<int>(0, 0)), regions.at(0).bounding_box_}};
+  });
+}
+
+static auto CountDropped(const std::vector<StreamStageStats> &stats) -> std::size_t {
+  std::size_t dropped = 0;
+  for (const auto &stage : stats) {
+    dropped += stage.dropped_;
+  }
+  return dropped;
+}
+
+TEST(TextSpotterStreamTest, BackpressureKeepsEveryFrameInOrder) {
+  TextSpotterStream stream("", 1, 1, false);
+  SetFakeStages(stream, std::chrono::milliseconds(1));
+  stream.SetTargets({"7"});
+
+  std::vector<StreamFrameResult> results;
+  stream.Start(CountingSource(30), [&results](const StreamFrameResult &result) { results.push_back(result); });
+  // The running stages keep the targets they started with.
+  stream.SetTargets({"7", "8", "9"});
+  stream.Wait();
+
+  ASSERT_EQ(results.size(), 30);
+  for (std::size_t i = 0; i < results.size(); ++i) {
+    EXPECT_EQ(results[i].frame_index_, i);
+    ASSERT_EQ(results[i].detections_.size(), 1);
+    EXPECT_EQ(results[i].detections_[0].text_, std::to_string(i));
+    EXPECT_EQ(results[i].matches_.size(), 1);
+  }
+  const auto stats = stream.GetStageStats();
+  EXPECT_EQ(CountDropped(stats), 0);
+  EXPECT_EQ(stats[0].frames_, 30);
+}
+
+TEST(TextSpotterStreamTest, DroppedFramesAreCounted) {
+  TextSpotterStream stream("", 1, 1, true);
+  // The capture outruns the read stage, which drops most frames.
+  SetFakeStages(stream, std::chrono::milliseconds(2));
+
+  std::vector<StreamFrameResult> results;
+  stream.Start(CountingSource(200), [&results](const StreamFrameResult &result) { results.push_back(result); });
+  stream.Wait();
+
+  const auto stats = stream.GetStageStats();
+  EXPECT_GT(CountDropped(stats), 0);
+  EXPECT_EQ(results.size() + CountDropped(stats), 200);
+  for (std::size_t i = 0; i < results.size(); ++i) {
+    if (i > 0) {
+      EXPECT_GT(results[i].frame_index_, results[i - 1].frame_index_);
+    }
+    ASSERT_EQ(results[i].detections_.size(), 1);
+    EXPECT_EQ(results[i].detections_[0].text_, std::to_string(results[i].frame_index_));
+  }
+}
+
+TEST(TextSpotterStreamTest, StopDuringRun) {
+  TextSpotterStream stream("", 1, 2, false);
+  SetFakeStages(stream, std::chrono::milliseconds(1));
+
+  // An endless source, only Stop() ends the run.
+  std::atomic<std::size_t> num_results = 0;
+  std::promise<void> running;
+  stream.Start(CountingSource(-1), [&num_results, &running](const StreamFrameResult &) {
+    if (++num_results == 3) {
+      running.set_value();
+    }
+  });
+  running.get_future().wait();
+  stream.Stop();
+  const auto stopped_at = num_results.load();
+  EXPECT_GE(stopped_at, 3);
+  EXPECT_GE(stream.GetStageStats()[0].frames_, stopped_at);
+
+  // A stopped stream starts again from a clean state.
+  std::vector<StreamFrameResult> results;
+  stream.Start(CountingSource(5), [&results](const StreamFrameResult &result) { results.push_back(result); });
+  stream.Wait();
+  EXPECT_EQ(num_results, stopped_at);
+  ASSERT_EQ(results.size(), 5);
+  EXPECT_EQ(results[0].frame_index_, 0);
+  EXPECT_EQ(stream.GetStageStats()[0].frames_, 5);
+}
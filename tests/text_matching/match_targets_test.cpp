@@ -0,0 +1,62 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "textspotter/text_index.hpp"
+#include "textspotter/text_matching.hpp"
+#include "textspotter/thread_pool.hpp"
+
+static auto MakeScreen() -> std::vector<DetectReadResult> {
+  return {
+      {"File", {0, 0, 40, 10}},
+      {"Edit", {50, 0, 40, 10}},
+      {"Save", {0, 100, 40, 10}},
+      {"as", {50, 100, 20, 10}},
+      {"Settings", {0, 200, 80, 10}},
+      {"Cancel", {300, 300, 60, 10}},
+      {"Save", {500, 500, 40, 10}},
+      {"Setting5", {600, 600, 80, 10}},
+  };
+}
+
+TEST(MatchTargetsTest, SingleWordScore) {
+  const auto detections = MakeScreen();
+  const TextIndex index(detections);
+
+  const auto exact = MatchTarget(detections, index, "cancel");
+  EXPECT_EQ(exact.point_, cv::Point(330, 305));
+  EXPECT_FLOAT_EQ(exact.score_, 1.0F);
+
+  const auto misread = MatchTarget(detections, index, "Cance1");
+  EXPECT_EQ(misread.point_, cv::Point(330, 305));
+  EXPECT_NEAR(misread.score_, 5.0F / 6.0F, 1e-6);
+
+  const auto missing = MatchTarget(detections, index, "Apply");
+  EXPECT_EQ(missing.point_, cv::Point(-1, -1));
+  EXPECT_FLOAT_EQ(missing.score_, 0.0F);
+}
+
+TEST(MatchTargetsTest, AgreesWithSingleQueries) {
+  const auto detections = MakeScreen();
+  const TextIndex index(detections);
+  const std::vector<std::string_view> targets{"Save as", "File Edit", "settings", "save", "Missing", "", "Save as"};
+
+  ThreadPool thread_pool(4);
+  const auto sequential = MatchTargets(detections, index, targets);
+  const auto parallel = MatchTargets(detections, index, targets, &thread_pool);
+  ASSERT_EQ(sequential.size(), targets.size());
+  ASSERT_EQ(parallel.size(), targets.size());
+
+  for (std::size_t i = 0; i < targets.size(); ++i) {
+    const auto single = MatchTarget(detections, index, targets[i]);
+    EXPECT_EQ(sequential[i].point_, single.point_) << targets[i];
+    EXPECT_EQ(parallel[i].point_, single.point_) << targets[i];
+    EXPECT_FLOAT_EQ(parallel[i].score_, single.score_) << targets[i];
+  }
+
+  EXPECT_EQ(sequential[0].point_, cv::Point(40, 105));
+  EXPECT_EQ(sequential[4].point_, cv::Point(-1, -1));
+  EXPECT_EQ(sequential[5].point_, cv::Point(-1, -1));
+}
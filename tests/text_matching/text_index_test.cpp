@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "textspotter/text_index.hpp"
+#include "textspotter/text_matching.hpp"
+
+static auto MakeDetections(const std::vector<std::string> &words) -> std::vector<DetectReadResult> {
+  std::vector<DetectReadResult> detections;
+  for (size_t i = 0; i < words.size(); ++i) {
+    detections.push_back({words[i], {static_cast<int>(i) * 10, 0, 8, 8}});
+  }
+  return detections;
+}
+
+TEST(TextIndexTest, EmptyIndex) {
+  const TextIndex index;
+  EXPECT_EQ(index.Size(), 0);
+  EXPECT_TRUE(index.Find("hello").empty());
+}
+
+TEST(TextIndexTest, FindsFuzzyMatches) {
+  const auto detections = MakeDetections({"Settings", "Cancel", "Setting5", "OK", "settings"});
+  const TextIndex index(detections);
+  EXPECT_EQ(index.Size(), 5);
+  // "Settings" and "settings" share an entry.
+  EXPECT_EQ(index.GetNumWords(), 4);
+
+  EXPECT_EQ(index.Find("settings"), (std::vector<std::size_t>{0, 2, 4}));
+  EXPECT_EQ(index.Find("CANCEL"), (std::vector<std::size_t>{1}));
+  EXPECT_TRUE(index.Find("Apply").empty());
+  EXPECT_EQ(index.Find("ok"), (std::vector<std::size_t>{3}));
+  // Too short to match anything.
+  EXPECT_TRUE(index.Find("O").empty());
+}
+
+TEST(TextIndexTest, AgreesWithLinearScan) {
+  std::mt19937 rng(7);
+  std::uniform_int_distribution<int> length_dist(1, 12);
+  std::uniform_int_distribution<int> char_dist('a', 'f');
+  const auto random_word = [&]() {
+    std::string word(length_dist(rng), ' ');
+    for (auto &c : word) {
+      c = static_cast<char>(char_dist(rng));
+    }
+    return word;
+  };
+
+  std::vector<std::string> words(500);
+  for (auto &word : words) {
+    word = random_word();
+  }
+  const auto detections = MakeDetections(words);
+  const TextIndex index(detections);
+
+  for (int i = 0; i < 200; ++i) {
+    const auto target = random_word();
+    std::vector<std::size_t> expected;
+    for (size_t j = 0; j < detections.size(); ++j) {
+      if (IsMatch(detections[j].text_, target)) {
+        expected.push_back(j);
+      }
+    }
+    EXPECT_EQ(index.Find(target), expected) << target;
+  }
+}
+
+TEST(TextIndexTest, MatchWordUsesFirstDetection) {
+  const auto detections = MakeDetections({"Cancel", "Open", "Cancel"});
+  const TextIndex index(detections);
+  EXPECT_EQ(MatchWord(detections, index, "cancel"), MatchWord(detections, "cancel"));
+  EXPECT_EQ(MatchWord(detections, index, "Missing"), cv::Point(-1, -1));
+}
@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "textspotter/text_index.hpp"
+#include "textspotter/text_matching.hpp"
+#include "textspotter/utility.hpp"
+
+/**
+ * @brief Reference implementation, scoring every combination of candidates.
+ */
+static auto BruteForceGroupCenter(const std::vector<DetectReadResult> &detections,
+                                  const std::vector<std::string> &target) -> cv::Point {
+  std::vector<std::vector<cv::Point>> candidates;
+  for (const auto &word : target) {
+    auto &centers = candidates.emplace_back();
+    for (const auto &res : detections) {
+      if (IsMatch(res.text_, word)) {
+        centers.push_back(GetRectCenter(res.bounding_box_));
+      }
+    }
+  }
+
+  double best_cost = std::numeric_limits<double>::max();
+  std::vector<cv::Point> best;
+  std::vector<std::size_t> choice(candidates.size(), 0);
+  while (true) {
+    std::vector<cv::Point> group;
+    for (std::size_t i = 0; i < choice.size(); ++i) {
+      if (candidates[i].empty()) {
+        return {-1, -1};
+      }
+      group.push_back(candidates[i][choice[i]]);
+    }
+    double cost = 0;
+    for (std::size_t i = 0; i < group.size(); ++i) {
+      for (std::size_t j = i + 1; j < group.size(); ++j) {
+        cost += cv::norm(group[i] - group[j]);
+      }
+    }
+    if (cost < best_cost) {
+      best_cost = cost;
+      best = group;
+    }
+
+    std::size_t i = 0;
+    while (i < choice.size() && ++choice[i] == candidates[i].size()) {
+      choice[i++] = 0;
+    }
+    if (i == choice.size()) {
+      break;
+    }
+  }
+
+  int x = 0, y = 0;
+  for (const auto &center : best) {
+    x += center.x;
+    y += center.y;
+  }
+  return {x / static_cast<int>(best.size()), y / static_cast<int>(best.size())};
+}
+
+static auto RandomDetections(std::mt19937 &rng, const std::vector<std::string> &words, int count)
+    -> std::vector<DetectReadResult> {
+  std::uniform_int_distribution<int> coordinate_dist(0, 1900);
+  std::uniform_int_distribution<std::size_t> word_dist(0, words.size() - 1);
+  std::vector<DetectReadResult> detections;
+  for (int i = 0; i < count; ++i) {
+    detections.push_back({words[word_dist(rng)], {coordinate_dist(rng), coordinate_dist(rng), 40, 12}});
+  }
+  return detections;
+}
+
+TEST(WordGroupsTest, FindsClosestGroup) {
+  const std::vector<DetectReadResult> detections{
+      {"Save", {0, 0, 40, 10}},
+      {"file", {900, 900, 40, 10}},
+      {"Save", {800, 900, 40, 10}},
+      {"file", {50, 0, 40, 10}},
+      {"Cancel", {400, 400, 60, 10}},
+  };
+  EXPECT_EQ(MatchWordGroups(detections, {"save", "file"}), cv::Point(45, 5));
+  EXPECT_EQ(MatchWordGroups(detections, {"save", "missing"}), cv::Point(-1, -1));
+}
+
+TEST(WordGroupsTest, AgreesWithBruteForce) {
+  std::mt19937 rng(3);
+  const std::vector<std::string> words{"open", "close", "file", "settings", "cancel", "apply"};
+  for (int trial = 0; trial < 30; ++trial) {
+    const auto detections = RandomDetections(rng, words, 60);
+    const std::vector<std::string> target{words[trial % 6], words[(trial + 1) % 6], words[(trial + 3) % 6]};
+    EXPECT_EQ(MatchWordGroups(detections, target), BruteForceGroupCenter(detections, target)) << trial;
+  }
+}
+
+TEST(WordGroupsTest, ManyRepeatedWords) {
+  // About 750 detections per word, the Cartesian product has hundreds of billions of groups.
+  std::mt19937 rng(5);
+  const auto detections = RandomDetections(rng, {"the", "and", "for", "next"}, 3000);
+  const TextIndex index(detections);
+  const auto center = MatchWordGroups(detections, index, {"the", "and", "for", "next"});
+  EXPECT_GE(center.x, 0);
+  EXPECT_GE(center.y, 0);
+}
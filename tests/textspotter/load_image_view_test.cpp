@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <memory>
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+#include "../east_detector/synthetic_east.hpp"
+#include "textspotter/east_detector.hpp"
+#include "textspotter/textspotter.hpp"
+
+TEST(LoadImageViewTest, LoadImageCopiesPixels) {
+  TextSpotter text_spotter("", false, 1);
+  cv::Mat image(20, 30, CV_8UC3, cv::Scalar(1, 2, 3));
+  text_spotter.LoadImage(image);
+
+  EXPECT_NE(text_spotter.GetImage().data, image.data);
+  image.setTo(cv::Scalar(0, 0, 0));
+  EXPECT_EQ(text_spotter.GetImage().at<cv::Vec3b>(0, 0), cv::Vec3b(1, 2, 3));
+}
+
+TEST(LoadImageViewTest, ViewSharesPixels) {
+  TextSpotter text_spotter("", false, 1);
+  const cv::Mat image(20, 30, CV_8UC3, cv::Scalar(1, 2, 3));
+  const cv::Mat region = image(cv::Rect(5, 5, 10, 10));
+  text_spotter.LoadImageView(region);
+
+  EXPECT_EQ(text_spotter.GetImage().data, region.data);
+  EXPECT_EQ(text_spotter.GetImage().size(), cv::Size(10, 10));
+  EXPECT_EQ(&text_spotter.GetImage(), &text_spotter.GetImage());
+}
+
+TEST(LoadImageViewTest, ExternalBufferWithStride) {
+  TextSpotter text_spotter("", false, 1);
+  // Rows of 30 pixels padded to 32 bytes.
+  constexpr int width = 30;
+  constexpr int height = 4;
+  constexpr std::size_t step = 32;
+  std::vector<std::uint8_t> buffer(step * height, 0);
+  for (int y = 0; y < height; ++y) {
+    buffer[y * step + 1] = static_cast<std::uint8_t>(y + 1);
+  }
+  text_spotter.LoadImageView(buffer.data(), width, height, CV_8UC1, step);
+
+  const cv::Mat &image = text_spotter.GetImage();
+  EXPECT_EQ(image.data, buffer.data());
+  EXPECT_EQ(image.size(), cv::Size(width, height));
+  EXPECT_EQ(image.step[0], step);
+  for (int y = 0; y < height; ++y) {
+    EXPECT_EQ(image.at<std::uint8_t>(y, 1), y + 1);
+  }
+
+  text_spotter.LoadImageView(nullptr, width, height, CV_8UC1);
+  EXPECT_TRUE(text_spotter.GetImage().empty());
+  EXPECT_TRUE(text_spotter.DetectRead().empty());
+}
+
+TEST(LoadImageViewTest, DetectReadOnGrayscaleView) {
+  TextSpotter text_spotter("", false, 1);
+  text_spotter.SetDetector(std::make_unique<EastTextDetector>(MakeSyntheticEast()));
+
+  // Without bright cells nothing is detected, so no Tesseract engine is needed.
+  std::vector<std::uint8_t> buffer(640 * 320, 0);
+  text_spotter.LoadImageView(buffer.data(), 640, 320, CV_8UC1);
+  EXPECT_TRUE(text_spotter.DetectRead().empty());
+
+  const cv::Mat bgra(320, 640, CV_8UC4, cv::Scalar::all(0));
+  text_spotter.LoadImageView(bgra);
+  EXPECT_TRUE(text_spotter.DetectRead().empty());
+}
@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+#include "textspotter/thread_pool.hpp"
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+TEST(ThreadPoolTest, DefaultSizeIsAtLeastOne) {
+  ThreadPool pool;
+  EXPECT_GE(pool.Size(), 1);
+}
+
+TEST(ThreadPoolTest, ResultsKeepSubmissionOrder) {
+  ThreadPool pool(4);
+  std::vector<std::future<int>> futures;
+  for (int i = 0; i < 1000; ++i) {
+    futures.push_back(pool.Submit([i]() { return i * i; }));
+  }
+  for (int i = 0; i < 1000; ++i) {
+    EXPECT_EQ(futures[i].get(), i * i);
+  }
+}
+
+TEST(ThreadPoolTest, PropagatesExceptions) {
+  ThreadPool pool(2);
+  auto future = pool.Submit([]() -> int { throw std::runtime_error("failed"); });
+  EXPECT_THROW(future.get(), std::runtime_error);
+}
+
+TEST(ThreadPoolTest, WorkerIndexOnlyInsidePool) {
+  ThreadPool pool(3);
+  EXPECT_FALSE(pool.CurrentWorkerIndex().has_value());
+
+  auto index = pool.Submit([&pool]() { return pool.CurrentWorkerIndex(); }).get();
+  ASSERT_TRUE(index.has_value());
+  EXPECT_LT(*index, pool.Size());
+}
+
+TEST(ThreadPoolTest, DestructorRunsQueuedTasks) {
+  std::atomic<int> count = 0;
+  {
+    ThreadPool pool(2);
+    for (int i = 0; i < 100; ++i) {
+      pool.Submit([&count]() { ++count; });
+    }
+  }
+  EXPECT_EQ(count, 100);
+}
+
+TEST(ThreadPoolTest, TasksSubmittedFromWorkers) {
+  ThreadPool pool(4);
+  std::atomic<int> sum = 0;
+  std::vector<std::future<std::vector<std::future<void>>>> outer;
+  for (int i = 0; i < 8; ++i) {
+    outer.push_back(pool.Submit([&pool, &sum]() {
+      std::vector<std::future<void>> inner;
+      for (int j = 0; j < 8; ++j) {
+        inner.push_back(pool.Submit([&sum]() { ++sum; }));
+      }
+      return inner;
+    }));
+  }
+  for (auto &f : outer) {
+    for (auto &inner : f.get()) {
+      inner.get();
+    }
+  }
+  EXPECT_EQ(sum, 64);
+}
+
+#ifdef __linux__
+TEST(ThreadPoolTest, PinsWorkersToCores) {
+  cpu_set_t allowed;
+  CPU_ZERO(&allowed);
+  ASSERT_EQ(sched_getaffinity(0, sizeof(allowed), &allowed), 0);
+  int core = 0;
+  while (!CPU_ISSET(core, &allowed)) {
+    ++core;
+  }
+
+  ThreadPool pool(2, {core});
+  for (int i = 0; i < 8; ++i) {
+    EXPECT_EQ(pool.Submit([]() { return sched_getcpu(); }).get(), core);
+  }
+}
+#endif
@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "textspotter/thread_pool.hpp"
+#include "textspotter/threading.hpp"
+
+TEST(ThreadingConfigTest, SplitsBudgetByDefault) {
+  ThreadingConfig config;
+  config.total_threads_ = 8;
+  const auto resolved = config.Resolve();
+  EXPECT_EQ(resolved.total_threads_, 8);
+  EXPECT_EQ(resolved.opencv_threads_, 2);
+  EXPECT_EQ(resolved.ocr_threads_, 6);
+  EXPECT_EQ(resolved.ocr_engine_threads_, 1);
+}
+
+TEST(ThreadingConfigTest, GivesRestOfBudget) {
+  ThreadingConfig config;
+  config.total_threads_ = 8;
+  config.ocr_threads_ = 3;
+  EXPECT_EQ(config.Resolve().opencv_threads_, 5);
+
+  config.ocr_threads_ = 0;
+  config.opencv_threads_ = 1;
+  EXPECT_EQ(config.Resolve().ocr_threads_, 7);
+}
+
+TEST(ThreadingConfigTest, EveryShareGetsOneThread) {
+  ThreadingConfig config;
+  config.total_threads_ = 1;
+  const auto resolved = config.Resolve();
+  EXPECT_EQ(resolved.opencv_threads_, 1);
+  EXPECT_EQ(resolved.ocr_threads_, 1);
+}
+
+TEST(ThreadingConfigTest, DefaultBudgetIsMachine) {
+  const auto resolved = ThreadingConfig{}.Resolve();
+  EXPECT_GE(resolved.total_threads_, 1);
+  EXPECT_GE(resolved.opencv_threads_, 1);
+  EXPECT_GE(resolved.ocr_threads_, 1);
+}
+
+TEST(ThreadingConfigTest, OcrCoresFollowOpenCvCores) {
+  ThreadingConfig config;
+  config.total_threads_ = 8;
+  EXPECT_TRUE(config.GetOcrCores().empty());
+
+  config.pin_threads_ = true;
+  config.first_core_ = 4;
+  EXPECT_EQ(config.GetOcrCores(), (std::vector<int>{6, 7, 8, 9, 10, 11}));
+}
+
+#ifdef _OPENMP
+TEST(ThreadingConfigTest, WorkersLimitEngineThreads) {
+  ThreadPool limited(2, {}, 1);
+  EXPECT_EQ(limited.Submit([] { return omp_get_max_threads(); }).get(), 1);
+
+  ThreadPool unlimited(1);
+  EXPECT_EQ(unlimited.Submit([] { return omp_get_max_threads(); }).get(), omp_get_max_threads());
+}
+#endif
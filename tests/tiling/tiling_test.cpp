@@ -0,0 +1,64 @@
+#include <gtest/gtest.h>
+
+#include <opencv2/core.hpp>
+#include <vector>
+
+#include "textspotter/tiling.hpp"
+
+TEST(TileOriginsTest, SingleTileWhenLengthFits) {
+  EXPECT_EQ(TileOrigins(500, 640, 64), std::vector<int>{0});
+  EXPECT_EQ(TileOrigins(640, 640, 64), std::vector<int>{0});
+}
+
+TEST(TileOriginsTest, LastTileAlignedWithEnd) {
+  EXPECT_EQ(TileOrigins(1000, 640, 64), (std::vector<int>{0, 360}));
+  EXPECT_EQ(TileOrigins(2000, 640, 64), (std::vector<int>{0, 576, 1152, 1360}));
+}
+
+class IsHeldByNeighbourTest : public ::testing::Test {
+ protected:
+  // Two tiles side by side, sharing a band of 64 pixels from x = 576 to x = 640.
+  const cv::Size image_size{1216, 320};
+  const cv::Rect left{0, 0, 640, 320};
+  const cv::Rect right{576, 0, 640, 320};
+  static constexpr int overlap = 64;
+
+  auto Count(const cv::Rect &box) const -> int {
+    const cv::Rect in_left(box.x - left.x, box.y - left.y, box.width, box.height);
+    const cv::Rect in_right(box.x - right.x, box.y - right.y, box.width, box.height);
+    int kept = 0;
+    kept += !IsHeldByNeighbour(in_left & cv::Rect(0, 0, left.width, left.height), left, image_size, overlap);
+    kept += !IsHeldByNeighbour(in_right & cv::Rect(0, 0, right.width, right.height), right, image_size, overlap);
+    return kept;
+  }
+};
+
+TEST_F(IsHeldByNeighbourTest, BoxCutInBandKeptByNeighbourOnly) {
+  const cv::Rect box(590, 10, 60, 20);
+  EXPECT_TRUE(IsHeldByNeighbour(cv::Rect(590, 10, 50, 20), left, image_size, overlap));
+  EXPECT_FALSE(IsHeldByNeighbour(cv::Rect(14, 10, 60, 20), right, image_size, overlap));
+  EXPECT_EQ(Count(box), 1);
+}
+
+TEST_F(IsHeldByNeighbourTest, BoxCoveringBandKeptByBoth) {
+  EXPECT_FALSE(IsHeldByNeighbour(cv::Rect(576, 10, 64, 20), left, image_size, overlap));
+  EXPECT_FALSE(IsHeldByNeighbour(cv::Rect(0, 10, 64, 20), right, image_size, overlap));
+  EXPECT_EQ(Count(cv::Rect(570, 10, 80, 20)), 2);
+}
+
+TEST_F(IsHeldByNeighbourTest, BoxLongerThanBandKeptByBoth) {
+  EXPECT_FALSE(IsHeldByNeighbour(cv::Rect(500, 10, 140, 20), left, image_size, overlap));
+  EXPECT_EQ(Count(cv::Rect(500, 10, 200, 20)), 2);
+}
+
+TEST_F(IsHeldByNeighbourTest, ImageBorderDoesNotCut) {
+  EXPECT_FALSE(IsHeldByNeighbour(cv::Rect(0, 10, 20, 20), left, image_size, overlap));
+  EXPECT_FALSE(IsHeldByNeighbour(cv::Rect(620, 300, 20, 20), right, image_size, overlap));
+}
+
+TEST_F(IsHeldByNeighbourTest, VerticalNeighbour) {
+  const cv::Size tall{640, 600};
+  const cv::Rect top(0, 0, 640, 320);
+  EXPECT_TRUE(IsHeldByNeighbour(cv::Rect(10, 290, 40, 30), top, tall, overlap));
+  EXPECT_FALSE(IsHeldByNeighbour(cv::Rect(10, 256, 40, 64), top, tall, overlap));
+}
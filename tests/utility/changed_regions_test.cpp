@@ -0,0 +1,60 @@
+#include <gtest/gtest.h>
+#include <opencv2/opencv.hpp>
+#include "textspotter/utility.hpp"
+
+TEST(ChangedRegionsTest, IdenticalFrames) {
+  const cv::Mat frame(240, 320, CV_8UC3, cv::Scalar(200, 200, 200));
+  EXPECT_TRUE(FindChangedRegions(frame, frame.clone()).empty());
+}
+
+TEST(ChangedRegionsTest, SingleChangedPatch) {
+  const cv::Mat previous(240, 320, CV_8UC3, cv::Scalar(200, 200, 200));
+  cv::Mat current = previous.clone();
+  const cv::Rect patch(100, 70, 20, 10);
+  current(patch).setTo(cv::Scalar(0, 0, 0));
+
+  const auto regions = FindChangedRegions(previous, current, 32);
+  ASSERT_EQ(regions.size(), 1);
+  EXPECT_EQ(regions[0] & patch, patch);
+}
+
+TEST(ChangedRegionsTest, SeparatePatches) {
+  const cv::Mat previous(240, 320, CV_8UC1, cv::Scalar(200));
+  cv::Mat current = previous.clone();
+  current(cv::Rect(0, 0, 16, 16)).setTo(cv::Scalar(0));
+  current(cv::Rect(300, 220, 20, 20)).setTo(cv::Scalar(0));
+
+  EXPECT_EQ(FindChangedRegions(previous, current, 32).size(), 2);
+}
+
+TEST(ChangedRegionsTest, DifferentSizes) {
+  const cv::Mat previous(240, 320, CV_8UC3, cv::Scalar(200, 200, 200));
+  const cv::Mat current(120, 160, CV_8UC3, cv::Scalar(200, 200, 200));
+
+  const auto regions = FindChangedRegions(previous, current);
+  ASSERT_EQ(regions.size(), 1);
+  EXPECT_EQ(regions[0], cv::Rect(0, 0, 160, 120));
+}
+
+TEST(ChangedRegionsTest, GrowByMarginWithinFrame) {
+  const cv::Rect bounds(0, 0, 320, 240);
+  const auto regions = GrowChangedRegions({{0, 0, 32, 32}, {288, 96, 32, 32}}, {}, 32, bounds);
+  ASSERT_EQ(regions.size(), 2);
+  EXPECT_EQ(regions[0], cv::Rect(0, 0, 64, 64));
+  EXPECT_EQ(regions[1], cv::Rect(256, 64, 64, 96));
+}
+
+TEST(ChangedRegionsTest, GrowByBoxTouchingMergedRegion) {
+  const cv::Rect bounds(0, 0, 320, 240);
+  // Joins the two changed blocks, which are merged into (0, 0, 96, 96).
+  const cv::Rect bridge(16, 16, 64, 56);
+  // Touches neither block, nor either of them grown by the bridge, only the region they are merged into.
+  const cv::Rect straddling(90, 8, 20, 8);
+  const cv::Rect clear(200, 8, 20, 8);
+
+  const auto regions = GrowChangedRegions({{0, 0, 32, 32}, {64, 64, 32, 32}}, {bridge, straddling, clear}, 0, bounds);
+  ASSERT_EQ(regions.size(), 1);
+  EXPECT_EQ(regions[0], cv::Rect(0, 0, 110, 96));
+  EXPECT_EQ(regions[0] & straddling, straddling);
+  EXPECT_EQ((regions[0] & clear).area(), 0);
+}
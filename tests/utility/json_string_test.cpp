@@ -0,0 +1,50 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "textspotter/utility.hpp"
+
+TEST(JsonStringTest, EscapesQuotesBackslashesAndControlCharacters) {
+  EXPECT_EQ(ToJsonString("plain"), "\"plain\"");
+  EXPECT_EQ(ToJsonString("say \"hi\""), "\"say \\\"hi\\\"\"");
+  EXPECT_EQ(ToJsonString("C:\\images"), "\"C:\\\\images\"");
+  EXPECT_EQ(ToJsonString("a\nb\tc"), "\"a\\u000ab\\u0009c\"");
+  EXPECT_EQ(ToJsonString(std::string("\x01", 1)), "\"\\u0001\"");
+}
+
+TEST(JsonStringTest, KeepsUtf8) { EXPECT_EQ(ToJsonString("caf\xc3\xa9"), "\"caf\xc3\xa9\""); }
+
+TEST(JsonStringTest, UnescapesEscapes) {
+  EXPECT_EQ(FromJsonString("\"say \\\"hi\\\"\""), "say \"hi\"");
+  EXPECT_EQ(FromJsonString("\"C:\\\\images\\/a.png\""), "C:\\images/a.png");
+  EXPECT_EQ(FromJsonString("\"\\u0041\\u001f\\n\""), std::string("A\x1f\n"));
+  EXPECT_EQ(FromJsonString("\"\\u00e9\""), "\xc3\xa9");
+}
+
+TEST(JsonStringTest, IgnoresTextAfterTheString) {
+  EXPECT_EQ(FromJsonString("\"a.png\",\"detections\":[]}"), "a.png");
+}
+
+TEST(JsonStringTest, RejectsIncompleteStrings) {
+  EXPECT_EQ(FromJsonString(""), std::nullopt);
+  EXPECT_EQ(FromJsonString("a.png\""), std::nullopt);
+  EXPECT_EQ(FromJsonString("\"a.png"), std::nullopt);
+  EXPECT_EQ(FromJsonString("\"a\\"), std::nullopt);
+  EXPECT_EQ(FromJsonString("\"\\u00\""), std::nullopt);
+}
+
+TEST(JsonStringTest, RoundTrip) {
+  std::string control;
+  for (char c = 1; c < 0x20; ++c) {
+    control += c;
+  }
+  const std::string texts[] = {"",
+                               "images/a \"quoted\" name.png",
+                               "C:\\images\\\\share\\a.png",
+                               control,
+                               std::string("nul\0byte", 8),
+                               "caf\xc3\xa9/\xe6\x97\xa5\xe6\x9c\xac.png"};
+  for (const auto &text : texts) {
+    EXPECT_EQ(FromJsonString(ToJsonString(text)), text);
+  }
+}
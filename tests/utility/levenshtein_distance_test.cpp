@@ -1,4 +1,7 @@
 #include <gtest/gtest.h>
+
+#include <string>
+
 #include "textspotter/utility.hpp"
 
 TEST(LevenshteinDistanceTest, EmptyStrings) { EXPECT_EQ(CalcLevenshteinDistance("", ""), 0); }
@@ -10,3 +13,34 @@ TEST(LevenshteinDistanceTest, SecondStringEmpty) { EXPECT_EQ(CalcLevenshteinDist
 TEST(LevenshteinDistanceTest, SameStrings) { EXPECT_EQ(CalcLevenshteinDistance("test", "test"), 0); }
 
 TEST(LevenshteinDistanceTest, DifferentStrings) { EXPECT_EQ(CalcLevenshteinDistance("kitten", "sitting"), 3); }
+
+TEST(LevenshteinDistanceTest, WithinBudget) { EXPECT_EQ(CalcLevenshteinDistance("kitten", "sitting", 3), 3); }
+
+TEST(LevenshteinDistanceTest, BudgetExceeded) { EXPECT_EQ(CalcLevenshteinDistance("kitten", "sitting", 2), 3); }
+
+TEST(LevenshteinDistanceTest, LengthGapExceedsBudget) { EXPECT_EQ(CalcLevenshteinDistance("ab", "abcdefgh", 1), 2); }
+
+TEST(LevenshteinDistanceTest, CaseInsensitive) {
+  EXPECT_EQ(CalcLevenshteinDistance("KiTTen", "kitten", 6, false), 0);
+  EXPECT_EQ(CalcLevenshteinDistance("KiTTen", "kitten", 6, true), 3);
+}
+
+TEST(LevenshteinDistanceTest, LongStrings) {
+  // Longer than a machine word, compared by the banded kernel.
+  const std::string s1(100, 'a');
+  std::string s2 = s1;
+  s2[10] = 'b';
+  s2[90] = 'c';
+  s2.push_back('d');
+  EXPECT_EQ(CalcLevenshteinDistance(s1, s2), 3);
+  EXPECT_EQ(CalcLevenshteinDistance(s1, s2, 3), 3);
+  EXPECT_EQ(CalcLevenshteinDistance(s1, s2, 2), 3);
+}
+
+TEST(LevenshteinDistanceTest, WordBoundary) {
+  // 64 characters still fit in one machine word, 65 do not.
+  const std::string s1(64, 'x');
+  const std::string s2 = "y" + s1;
+  EXPECT_EQ(CalcLevenshteinDistance(s1, s2), 1);
+  EXPECT_EQ(CalcLevenshteinDistance(s2, s1 + "zz"), 3);
+}
@@ -62,3 +62,15 @@ TEST_F(LoadImageTest, ThrowExceptionForInvalidPathStringView) {
   // Act & Assert
   EXPECT_THROW(LoadImage(invalidImagePath), std::invalid_argument);
 }
+
+TEST_F(LoadImageTest, ResizeByDefault) {
+  const cv::Mat result = LoadImage(temp_image_path.c_str());
+
+  EXPECT_EQ(result.size(), cv::Size(1280, 720));
+}
+
+TEST_F(LoadImageTest, KeepNativeResolution) {
+  const cv::Mat result = LoadImage(temp_image_path.c_str(), cv::Size());
+
+  EXPECT_EQ(result.size(), cv::Size(100, 100));
+}
@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+
+#include <opencv2/imgproc.hpp>
+#include <vector>
+
+#include "textspotter/utility.hpp"
+
+/**
+ * @brief Maps points of a crop to the image, with the transform given by RectifyRegion.
+ */
+static auto MapPoints(const std::vector<cv::Point2f> &points, const cv::Mat &crop_to_image)
+    -> std::vector<cv::Point2f> {
+  std::vector<cv::Point2f> mapped;
+  cv::transform(points, mapped, crop_to_image);
+  return mapped;
+}
+
+TEST(RectifyRegionTest, CropsRotatedBoxUpright) {
+  const cv::RotatedRect box({100.0F, 80.0F}, {80.0F, 20.0F}, 30.0F);
+  cv::Mat image(160, 200, CV_8UC1, cv::Scalar(0));
+  cv::Point2f vertices[4];
+  box.points(vertices);
+  const std::vector<cv::Point> polygon(vertices, vertices + 4);
+  cv::fillConvexPoly(image, polygon, cv::Scalar(255));
+
+  cv::Mat crop_to_image;
+  const auto crop = RectifyRegion(image, box, 5, crop_to_image);
+  ASSERT_EQ(crop.size(), cv::Size(90, 30));
+  ASSERT_EQ(crop_to_image.size(), cv::Size(3, 2));
+
+  // The corners of the crop land on the corners of the padded box, in the same order.
+  const cv::RotatedRect padded(box.center, {90.0F, 30.0F}, box.angle);
+  padded.points(vertices);
+  const auto corners = MapPoints({{0.0F, 0.0F}, {90.0F, 0.0F}, {90.0F, 30.0F}, {0.0F, 30.0F}}, crop_to_image);
+  const cv::Point2f expected[4] = {vertices[1], vertices[2], vertices[3], vertices[0]};
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_NEAR(corners[i].x, expected[i].x, 1e-3) << i;
+    EXPECT_NEAR(corners[i].y, expected[i].y, 1e-3) << i;
+  }
+
+  // The box fills the crop but the padding.
+  EXPECT_EQ(crop.at<uchar>(15, 45), 255);
+  EXPECT_EQ(crop.at<uchar>(8, 8), 255);
+  EXPECT_EQ(crop.at<uchar>(21, 81), 255);
+  EXPECT_EQ(crop.at<uchar>(2, 2), 0);
+  EXPECT_EQ(crop.at<uchar>(27, 87), 0);
+}
+
+TEST(RectifyRegionTest, EmptyRegion) {
+  const cv::Mat image(100, 100, CV_8UC1, cv::Scalar(0));
+  cv::Mat crop_to_image;
+  EXPECT_TRUE(RectifyRegion(image, cv::RotatedRect({50.0F, 50.0F}, {0.0F, 0.0F}, 30.0F), 0, crop_to_image).empty());
+  EXPECT_TRUE(RectifyRegion(cv::Mat(), cv::RotatedRect({50.0F, 50.0F}, {40.0F, 10.0F}, 30.0F), 2, crop_to_image)
+                  .empty());
+}
+
+TEST(MapCropToImageTest, MapsUprightBoxBackToRotatedBox) {
+  // A vertical box: the width of the crop runs down the image.
+  const cv::RotatedRect box({50.0F, 40.0F}, {40.0F, 10.0F}, 90.0F);
+  const cv::Mat image(100, 100, CV_8UC1, cv::Scalar(0));
+  cv::Mat crop_to_image;
+  const auto crop = RectifyRegion(image, box, 0, crop_to_image);
+  ASSERT_EQ(crop.size(), cv::Size(40, 10));
+
+  EXPECT_EQ(MapCropToImage({0, 0, 40, 10}, crop_to_image, image.size()), cv::Rect(45, 20, 10, 40));
+  // The first half of the crop is one end of the box.
+  const auto half = MapCropToImage({0, 0, 20, 10}, crop_to_image, image.size());
+  EXPECT_EQ(half.size(), cv::Size(10, 20));
+  EXPECT_TRUE(half == cv::Rect(45, 20, 10, 20) || half == cv::Rect(45, 40, 10, 20)) << half;
+}
+
+TEST(MapCropToImageTest, ClipsToImage) {
+  const cv::Mat crop_to_image = (cv::Mat_<double>(2, 3) << 1.0, 0.0, -10.0, 0.0, 1.0, 90.0);
+  EXPECT_EQ(MapCropToImage({0, 0, 30, 20}, crop_to_image, {100, 100}), cv::Rect(0, 90, 20, 10));
+  EXPECT_EQ(MapCropToImage({20, 5, 30, 5}, crop_to_image, {100, 100}), cv::Rect(10, 95, 30, 5));
+}
+
+TEST(FoldAngleTest, FoldsIntoHalfTurn) {
+  EXPECT_FLOAT_EQ(FoldAngle(0.0F), 0.0F);
+  EXPECT_FLOAT_EQ(FoldAngle(30.0F), 30.0F);
+  EXPECT_FLOAT_EQ(FoldAngle(-30.0F), -30.0F);
+  EXPECT_FLOAT_EQ(FoldAngle(90.0F), 90.0F);
+  EXPECT_FLOAT_EQ(FoldAngle(-90.0F), -90.0F);
+  EXPECT_FLOAT_EQ(FoldAngle(150.0F), -30.0F);
+  EXPECT_FLOAT_EQ(FoldAngle(-150.0F), 30.0F);
+  EXPECT_FLOAT_EQ(FoldAngle(180.0F), 0.0F);
+  EXPECT_FLOAT_EQ(FoldAngle(210.0F), 30.0F);
+  EXPECT_FLOAT_EQ(FoldAngle(450.0F), 90.0F);
+}
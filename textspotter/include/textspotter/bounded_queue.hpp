@@ -0,0 +1,123 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <optional>
+
+/**
+ * @class BoundedQueue
+ * @brief A thread-safe FIFO queue holding at most a fixed number of items, linking the stages of a pipeline.
+ *
+ * @details A producer either waits for room (Push) or makes room by dropping the oldest item (PushOrDrop), which keeps
+ * the latency of a live stream bounded when a later stage cannot keep up. Closing the queue wakes every waiting
+ * thread: pushes are then ignored, and pops return the remaining items before returning std::nullopt.
+ */
+template <typename T>
+class BoundedQueue {
+ public:
+  /**
+   * @brief Constructs an empty queue.
+   *
+   * @param capacity Maximum number of items held, at least 1.
+   */
+  explicit BoundedQueue(std::size_t capacity) : capacity_(capacity > 0 ? capacity : 1), closed_(false) {}
+
+  /**
+   * @brief Appends an item, waiting while the queue is full.
+   *
+   * @return False if the queue was closed, then the item is discarded.
+   */
+  auto Push(T item) -> bool {
+    std::unique_lock lock(mutex_);
+    not_full_.wait(lock, [this] { return closed_ || items_.size() < capacity_; });
+    if (closed_) {
+      return false;
+    }
+    items_.push_back(std::move(item));
+    lock.unlock();
+    not_empty_.notify_one();
+    return true;
+  }
+
+  /**
+   * @brief Appends an item, dropping the oldest one if the queue is full.
+   *
+   * @return True if an item was dropped. An item pushed to a closed queue is discarded and counts as dropped.
+   */
+  auto PushOrDrop(T item) -> bool {
+    std::unique_lock lock(mutex_);
+    if (closed_) {
+      return true;
+    }
+    bool dropped = false;
+    if (items_.size() >= capacity_) {
+      items_.pop_front();
+      dropped = true;
+    }
+    items_.push_back(std::move(item));
+    lock.unlock();
+    not_empty_.notify_one();
+    return dropped;
+  }
+
+  /**
+   * @brief Removes the oldest item, waiting while the queue is empty and open.
+   *
+   * @return The item, or std::nullopt if the queue is closed and empty.
+   */
+  auto Pop() -> std::optional<T> {
+    std::unique_lock lock(mutex_);
+    not_empty_.wait(lock, [this] { return closed_ || !items_.empty(); });
+    if (items_.empty()) {
+      return std::nullopt;
+    }
+    auto item = std::move(items_.front());
+    items_.pop_front();
+    lock.unlock();
+    not_full_.notify_one();
+    return item;
+  }
+
+  /**
+   * @brief Closes the queue, waking every waiting thread.
+   */
+  auto Close() -> void {
+    {
+      const std::lock_guard lock(mutex_);
+      closed_ = true;
+    }
+    not_empty_.notify_all();
+    not_full_.notify_all();
+  }
+
+  /**
+   * @brief Closes the queue and discards the remaining items.
+   */
+  auto Cancel() -> void {
+    {
+      const std::lock_guard lock(mutex_);
+      closed_ = true;
+      items_.clear();
+    }
+    not_empty_.notify_all();
+    not_full_.notify_all();
+  }
+
+  /**
+   * @brief Gets the number of items in the queue.
+   */
+  auto Size() const -> std::size_t {
+    const std::lock_guard lock(mutex_);
+    return items_.size();
+  }
+
+ private:
+  const std::size_t capacity_;         // Maximum number of items held.
+  bool closed_;                        // Whether the queue was closed.
+  std::deque<T> items_;                // The items, the oldest first.
+  mutable std::mutex mutex_;           // Protects the items and the closed flag.
+  std::condition_variable not_empty_;  // Signaled when an item is pushed or the queue is closed.
+  std::condition_variable not_full_;   // Signaled when an item is popped or the queue is closed.
+};
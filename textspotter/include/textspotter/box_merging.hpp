@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <opencv2/core.hpp>
+#include <vector>
+
+#include "textspotter/result_type.hpp"
+
+/**
+ * @struct BoxMergeOptions
+ * @brief How detected boxes are consolidated into the regions handed to the OCR engine.
+ */
+struct BoxMergeOptions {
+  /**
+   * @brief Number of pixels added around every region before recognition.
+   *
+   * @details Boxes of a line closer than twice the tolerance are always merged, their recognized regions would share
+   * pixels otherwise.
+   */
+  int tolerance_ = 5;
+
+  /**
+   * @brief Largest horizontal gap between two boxes of a line, as a fraction of the height of the taller box.
+   */
+  float max_gap_ratio_ = 1.0F;
+
+  /**
+   * @brief Smallest vertical overlap of two boxes of a line, as a fraction of the height of the shorter box.
+   */
+  float min_vertical_overlap_ = 0.6F;
+
+  /**
+   * @brief Largest ratio between the heights of two boxes of a line, text of very different sizes is kept apart.
+   */
+  float max_height_ratio_ = 2.0F;
+
+  /**
+   * @brief Boxes slanted by at least this many degrees are never merged, so that they can still be rectified.
+   */
+  float max_angle_ = 90.0F;
+};
+
+/**
+ * @function MergeTextBoxes
+ * @brief Merges the detected boxes that overlap or follow each other on a line into single regions.
+ *
+ * @details EAST often returns every word of a line as its own box, and the boxes overlap once expanded for
+ * recognition, so the same pixels are recognized several times and a word can be read twice. Overlapping boxes, and
+ * boxes of similar height sharing a line with a gap of at most max_gap_ratio_ times their height, are merged into the
+ * box bounding them all, until no two regions can be merged. Boxes of neighbouring lines only touching through their
+ * tolerance are kept apart, so that every merged region holds one line. A merged region takes the highest confidence
+ * of its boxes and has no rotated box, so it is not rectified. The regions are returned in the order of their first
+ * box.
+ *
+ * @param detections The detected boxes.
+ * @param options How the boxes are merged. Defaults to BoxMergeOptions{}.
+ * @return The merged regions, a box merged with no other is returned unchanged.
+ */
+auto MergeTextBoxes(const std::vector<TextDetectionResult> &detections, const BoxMergeOptions &options = {})
+    -> std::vector<TextDetectionResult>;
+
+/**
+ * @function CalcIoU
+ * @brief Calculates the intersection over union of two rectangles.
+ *
+ * @return The ratio, from 0 for disjoint rectangles to 1 for equal ones, 0 if both are empty.
+ */
+auto CalcIoU(const cv::Rect &a, const cv::Rect &b) noexcept -> float;
+
+/**
+ * @function SuppressDuplicateResults
+ * @brief Removes the results reading the same pixels twice, keeping the most confident one.
+ *
+ * @details Two results are duplicates when the intersection over union of their boxes reaches the threshold. The
+ * order of the remaining results is kept.
+ *
+ * @param results The recognized words, modified in place.
+ * @param iou_threshold Smallest intersection over union of two duplicates (default: 0.5).
+ * @return The number of results removed.
+ */
+auto SuppressDuplicateResults(std::vector<DetectReadResult> &results, float iou_threshold = 0.5F) -> std::size_t;
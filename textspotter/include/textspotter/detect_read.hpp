@@ -4,8 +4,145 @@
 #include <string>
 #include <vector>
 
+#include "box_merging.hpp"
 #include "result_type.hpp"
 
+class EastTextDetector;
+class LazyPreprocessor;
+class Metrics;
+class OcrCache;
+class PreprocessPipeline;
+class TesseractPool;
+class ThreadPool;
+
+/**
+ * @enum OmpSchedule
+ * @brief Loop scheduling policy of the OpenMP recognition stage.
+ */
+enum class OmpSchedule {
+  kStatic,   // Detections are split into fixed chunks ahead of time.
+  kDynamic,  // Threads take the next chunk when they finish the previous one.
+  kGuided,   // Like kDynamic, with chunks shrinking as the loop progresses.
+};
+
+/**
+ * @enum PreprocessMode
+ * @brief How the image is preprocessed before recognition.
+ */
+enum class PreprocessMode {
+  kFull,  // The whole image is preprocessed up front.
+  kLazy,  // Only the tiles overlapping a detected region are preprocessed, see LazyPreprocessor.
+};
+
+/**
+ * @struct DetectReadOptions
+ * @brief Tuning options of the detect and read pipeline.
+ */
+struct DetectReadOptions {
+  /**
+   * @brief Number of OpenMP threads recognizing the detected regions, 0 means the OpenMP default.
+   *
+   * @details Only used by DetectReadText when the library is built with enable_omp.
+   */
+  int omp_num_threads_ = 0;
+
+  /**
+   * @brief Scheduling policy of the OpenMP recognition loop.
+   */
+  OmpSchedule omp_schedule_ = OmpSchedule::kDynamic;
+
+  /**
+   * @brief Number of detections per OpenMP chunk.
+   */
+  int omp_chunk_size_ = 1;
+
+  /**
+   * @brief Whether slanted regions are warped into an upright crop before recognition.
+   *
+   * @details Without rectification, a slanted region is recognized within its axis-aligned bounding box, which holds
+   * more background pixels the more the text is slanted.
+   */
+  bool rectify_rotated_ = false;
+
+  /**
+   * @brief Minimum slant, in degrees, for a region to be rectified.
+   */
+  float rectify_min_angle_ = 5.0F;
+
+  /**
+   * @brief How the image is preprocessed before recognition.
+   *
+   * @details kLazy skips the pixels far from any detected region, which saves most of the preprocessing time on
+   * images with little text.
+   */
+  PreprocessMode preprocess_mode_ = PreprocessMode::kFull;
+
+  /**
+   * @brief Tile cache used in PreprocessMode::kLazy, nullptr builds a new one for every call.
+   *
+   * @details Lets the calls reading regions of the same image share the tiles already preprocessed. It must be built
+   * for that image with preprocess_pipeline_, and outlive the call.
+   */
+  LazyPreprocessor *lazy_preprocessor_ = nullptr;
+
+  /**
+   * @brief The pipeline preparing the image for recognition, nullptr means the default one, see Preprocess().
+   *
+   * @details The pipeline must outlive the call, its stage timings accumulate over the calls using it.
+   */
+  const PreprocessPipeline *preprocess_pipeline_ = nullptr;
+
+  /**
+   * @brief Cache of recognized regions consulted before running the engine, nullptr disables caching.
+   *
+   * @details The cache must outlive the call.
+   */
+  OcrCache *ocr_cache_ = nullptr;
+
+  /**
+   * @brief Metrics the stage timings and counts are recorded in, nullptr disables the instrumentation.
+   *
+   * @details The metrics must outlive the call.
+   */
+  Metrics *metrics_ = nullptr;
+
+  /**
+   * @brief Whether text is detected tile by tile at the native resolution of the image, see
+   * EastTextDetector::detectTiled.
+   *
+   * @details Finds small text in images much larger than the network input, at the cost of one forward pass per
+   * tile.
+   */
+  bool tiled_detection_ = false;
+
+  /**
+   * @brief Number of pixels shared by neighbouring tiles in tiled detection.
+   */
+  int tile_overlap_ = 64;
+
+  /**
+   * @brief Whether overlapping boxes and boxes of a same line are merged before recognition, see MergeTextBoxes.
+   *
+   * @details Fewer and larger regions are recognized, without recognizing the same pixels twice. Every merged region
+   * holds one line, which suits RecognitionProfile::SingleLine(). Slanted boxes are not merged when rectify_rotated_
+   * is set.
+   */
+  bool merge_boxes_ = false;
+
+  /**
+   * @brief How the boxes are merged when merge_boxes_ is set.
+   */
+  BoxMergeOptions box_merge_;
+
+  /**
+   * @brief Smallest intersection over union of two recognized words for the less confident one to be dropped, 0
+   * keeps every word.
+   *
+   * @details Removes the words read twice from overlapping regions, see SuppressDuplicateResults.
+   */
+  float duplicate_iou_threshold_ = 0.0F;
+};
+
 /**
  * @function DetectReadText
  * @brief Detects and reads text from an image using a specified model.
@@ -22,13 +159,49 @@
 auto DetectReadText(const cv::Mat &image, std::string_view model_path = "frozen_east_text_detection.pb",
                     bool display = false) noexcept -> std::vector<DetectReadResult>;
 
+/**
+ * @overload
+ * @brief Detects and reads text from an image, reusing the Tesseract engines of the given pool.
+ *
+ * @param image The image (cv::Mat) from which text is to be detected and read.
+ * @param model_path The path to the EAST model file.
+ * @param tesseract_pool The pool of Tesseract engines used for recognition.
+ * @param display A flag indicating whether to display the detection results. Defaults to false.
+ * @return A vector of DetectReadResult, each containing the detected and read text along with its bounding box.
+ * @throws This function is noexcept and does not throw exceptions.
+ */
+auto DetectReadText(const cv::Mat &image, std::string_view model_path, TesseractPool &tesseract_pool,
+                    bool display = false) noexcept -> std::vector<DetectReadResult>;
+
+/**
+ * @overload
+ * @brief Detects and reads text from an image with an already loaded EAST detector.
+ *
+ * @details The detector is not reloaded, so a long-lived (and warmed up) detector only pays the model loading cost
+ * once. The detector must not be used by another thread at the same time. When built with enable_omp, the detected
+ * regions are recognized by an OpenMP loop configured by the options, the results are still returned in detection
+ * order.
+ *
+ * @param image The image (cv::Mat) from which text is to be detected and read.
+ * @param detector The loaded EAST text detector.
+ * @param tesseract_pool The pool of Tesseract engines used for recognition.
+ * @param display A flag indicating whether to display the detection results. Defaults to false.
+ * @param options Tuning options of the pipeline. Defaults to DetectReadOptions{}.
+ * @return A vector of DetectReadResult, each containing the detected and read text along with its bounding box.
+ * @throws This function is noexcept and does not throw exceptions.
+ */
+auto DetectReadText(const cv::Mat &image, const EastTextDetector &detector, TesseractPool &tesseract_pool,
+                    bool display = false, const DetectReadOptions &options = {}) noexcept
+    -> std::vector<DetectReadResult>;
+
 /**
  * @function DetectReadTextMultiThread
  * @brief Detects and reads text from an image using a specified model, employing multi-threading for improved
  * performance.
  *
  * @details Similar to DetectReadText, this function uses the EAST model to detect and read text from an image.
- * It is optimized for performance by using multiple threads. The function can optionally display the detection results.
+ * It is optimized for performance by recognizing the detected regions on the process-wide thread pool. The function
+ * can optionally display the detection results.
  *
  * @param image The image (cv::Mat) from which text is to be detected and read.
  * @param model_path The path to the EAST model file. Defaults to "frozen_east_text_detection.pb".
@@ -38,3 +211,75 @@ auto DetectReadText(const cv::Mat &image, std::string_view model_path = "frozen_
  */
 auto DetectReadTextMultiThread(const cv::Mat &image, std::string_view model_path = "frozen_east_text_detection.pb",
                                bool display = false) noexcept -> std::vector<DetectReadResult>;
+
+/**
+ * @overload
+ * @brief Detects and reads text from an image with multiple threads, reusing the Tesseract engines of the given pool.
+ *
+ * @param image The image (cv::Mat) from which text is to be detected and read.
+ * @param model_path The path to the EAST model file.
+ * @param tesseract_pool The pool of Tesseract engines used for recognition.
+ * @param display A flag indicating whether to display the detection results. Defaults to false.
+ * @return A vector of DetectReadResult, each containing the detected and read text along with its bounding box.
+ * @throws This function is noexcept and does not throw exceptions.
+ */
+auto DetectReadTextMultiThread(const cv::Mat &image, std::string_view model_path, TesseractPool &tesseract_pool,
+                               bool display = false) noexcept -> std::vector<DetectReadResult>;
+
+/**
+ * @overload
+ * @brief Detects and reads text from an image with multiple threads and an already loaded EAST detector.
+ *
+ * @details The recognition of every detected region is submitted as a task to the thread pool, the results are
+ * gathered in detection order.
+ *
+ * @param image The image (cv::Mat) from which text is to be detected and read.
+ * @param detector The loaded EAST text detector.
+ * @param tesseract_pool The pool of Tesseract engines used for recognition.
+ * @param thread_pool The pool of worker threads running the recognition tasks.
+ * @param display A flag indicating whether to display the detection results. Defaults to false.
+ * @param options Tuning options of the pipeline, the OpenMP options are ignored. Defaults to DetectReadOptions{}.
+ * @return A vector of DetectReadResult, each containing the detected and read text along with its bounding box.
+ * @throws This function is noexcept and does not throw exceptions.
+ */
+auto DetectReadTextMultiThread(const cv::Mat &image, const EastTextDetector &detector, TesseractPool &tesseract_pool,
+                               ThreadPool &thread_pool, bool display = false,
+                               const DetectReadOptions &options = {}) noexcept -> std::vector<DetectReadResult>;
+
+/**
+ * @function DetectTextRegions
+ * @brief Detects the text regions of an image without recognizing them.
+ *
+ * @details The detection half of DetectReadText, tile by tile and with the boxes merged when enabled by the options,
+ * for callers recognizing the regions later or only some of them. Pass the regions to ReadDetectedText with
+ * merge_boxes_ unset, they are already merged.
+ *
+ * @param image The image (cv::Mat) in which text is detected.
+ * @param detector The loaded EAST text detector.
+ * @param options Tuning options of the pipeline. Defaults to DetectReadOptions{}.
+ * @return The detected regions.
+ * @throws This function is noexcept and does not throw exceptions.
+ */
+auto DetectTextRegions(const cv::Mat &image, const EastTextDetector &detector,
+                       const DetectReadOptions &options = {}) noexcept -> std::vector<TextDetectionResult>;
+
+/**
+ * @function ReadDetectedText
+ * @brief Recognizes the text of regions already detected in an image.
+ *
+ * @details The recognition half of DetectReadText and DetectReadTextMultiThread, for callers running the detection
+ * separately, e.g. as a stage of a pipeline. The results are returned in detection order, merged regions coming at
+ * the place of their first box.
+ *
+ * @param image The image (cv::Mat) in which the regions were detected.
+ * @param detection_results The detected regions.
+ * @param tesseract_pool The pool of Tesseract engines used for recognition.
+ * @param thread_pool The pool of worker threads running the recognition tasks, nullptr to recognize the regions on
+ * the calling thread, or with OpenMP when built with enable_omp.
+ * @param options Tuning options of the pipeline. Defaults to DetectReadOptions{}.
+ * @return A vector of DetectReadResult, each containing the detected and read text along with its bounding box.
+ * @throws This function is noexcept and does not throw exceptions.
+ */
+auto ReadDetectedText(const cv::Mat &image, const std::vector<TextDetectionResult> &detection_results,
+                      TesseractPool &tesseract_pool, ThreadPool *thread_pool,
+                      const DetectReadOptions &options = {}) noexcept -> std::vector<DetectReadResult>;
@@ -1,11 +1,15 @@
 #pragma once
 
+#include <cstddef>
 #include <memory>
 #include <opencv2/core.hpp>
 #include <opencv2/dnn.hpp>
+#include <vector>
 
 #include "textspotter/result_type.hpp"
 
+class Metrics;
+
 /**
  * @class EastTextDetector
  * @brief A class for detecting text in images using the EAST (Efficient and Accurate Scene Text Detection) model.
@@ -44,15 +48,84 @@ class EastTextDetector {
 
   /**
    * @brief Detects text in a given image.
-   * @param image Image in which to detect text.
+   * @param image Image in which to detect text, BGR, BGRA or grayscale. The network takes BGR, other layouts are
+   * converted first and images with another number of channels give no result.
    * @return A vector of TextDetectionResult objects, each representing a detected text instance.
    * @throws This method is noexcept and does not throw exceptions.
    */
   auto detect(const cv::Mat &image) const noexcept -> std::vector<TextDetectionResult>;
 
+  /**
+   * @brief Detects text in several images with a single forward pass.
+   *
+   * @details All images are resized to the network input size and stacked into one NCHW blob, the score and geometry
+   * maps of every image are then decoded and filtered by non-maximum suppression separately. Empty images produce
+   * an empty result.
+   *
+   * @param images Images in which to detect text, converted like in detect().
+   * @return One vector of TextDetectionResult per input image, in input order.
+   * @throws This method is noexcept and does not throw exceptions.
+   */
+  auto detectBatch(const std::vector<cv::Mat> &images) const noexcept -> std::vector<std::vector<TextDetectionResult>>;
+
+  /**
+   * @brief Detects text in a large image at its native resolution, tile by tile.
+   *
+   * @details detect() squeezes the whole image into the network input, so small text of a large image is lost. Here
+   * the image is split into overlapping tiles of the network input size, which are detected in batches. Boxes cut by
+   * the border of a tile are dropped when the neighbouring tile holds them whole, see IsHeldByNeighbour(), the others
+   * are merged by a global non-maximum suppression. An image not larger than the network input is passed to detect().
+   *
+   * @param image Image in which to detect text, converted like in detect().
+   * @param overlap Number of pixels shared by neighbouring tiles, text shorter than this is never cut (default: 64).
+   * @param max_batch_size Maximum number of tiles per forward pass (default: 8).
+   * @return A vector of TextDetectionResult objects, in image coordinates.
+   * @throws This method is noexcept and does not throw exceptions.
+   */
+  auto detectTiled(const cv::Mat &image, int overlap = 64, std::size_t max_batch_size = 8) const noexcept
+      -> std::vector<TextDetectionResult>;
+
+  /**
+   * @brief Runs a dummy inference so that the network allocates its buffers before the first real image.
+   *
+   * @details The first forward pass of a cv::dnn network initializes its layers and allocates intermediate blobs,
+   * which makes it considerably slower than the following ones. Calling this once after construction moves that cost
+   * out of the first detection.
+   */
+  auto Warmup() const noexcept -> void;
+
+  /**
+   * @brief Sets the metrics the forward passes and the decoding are timed in, nullptr disables the instrumentation.
+   *
+   * @details Only detectBatch() and detectTiled() run the network and the decoding separately, detect() leaves both to
+   * the OpenCV model and is timed as a whole by the caller. The metrics must outlive the detector or be reset first.
+   *
+   * @param metrics The metrics, may be nullptr.
+   */
+  auto SetMetrics(Metrics *metrics) noexcept -> void { metrics_ = metrics; }
+
  private:
   /**
    * @brief Unique pointer to the EAST text detection model.
    */
   std::unique_ptr<cv::dnn::TextDetectionModel_EAST> detector_;
+
+  /**
+   * @brief Decodes the score and geometry maps of one image of a batch into rotated boxes.
+   * @param scores Score maps of the batch, N x 1 x H/4 x W/4.
+   * @param geometry Geometry maps of the batch, N x 5 x H/4 x W/4.
+   * @param index Index of the image in the batch.
+   * @param boxes Output rotated boxes, in network input coordinates.
+   * @param confidences Output confidence of each box.
+   */
+  auto decode(const cv::Mat &scores, const cv::Mat &geometry, int index, std::vector<cv::RotatedRect> &boxes,
+              std::vector<float> &confidences) const -> void;
+
+  float conf_threshold_;    // Confidence threshold for the detection.
+  float nms_threshold_;     // Non-maximum suppression threshold.
+  cv::Size input_size_;     // Size of the network input.
+  double detect_scale_;     // Scale factor applied to the pixel values.
+  cv::Scalar detect_mean_;  // Mean subtracted from each channel.
+  bool swap_rb_;            // Whether to swap the red and blue channels.
+  Metrics *metrics_;        // Where the stages are timed, may be nullptr.
 };
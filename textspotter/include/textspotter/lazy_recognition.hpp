@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <opencv2/core.hpp>
+#include <string_view>
+#include <vector>
+
+#include "textspotter/result_type.hpp"
+#include "textspotter/text_index.hpp"
+
+/**
+ * @function RankRegion
+ * @brief Estimates how unlikely a region is to hold a target, the regions with the lowest cost are read first.
+ *
+ * @details A character is about half as wide as it is high, so a region holding only the target is about half its
+ * height times the length of the target wide. A narrower region cannot hold the target, a wider one may hold it among
+ * other words and costs less. The distance to the previous match, relative to the image diagonal, breaks the ties.
+ *
+ * @param box The bounding box of the region.
+ * @param target_length The number of characters of the target.
+ * @param last_hit The position of the previous match, {-1, -1} if there is none.
+ * @param diagonal The length of the diagonal of the image.
+ * @return The cost, 0 for a region of the expected width at the previous match.
+ */
+auto RankRegion(const cv::Rect &box, std::size_t target_length, const cv::Point &last_hit, double diagonal) noexcept
+    -> double;
+
+/**
+ * @class LazyRecognizer
+ * @brief Recognizes the detected regions of an image on demand, the ones most likely to hold a queried target first.
+ *
+ * @details The regions recognized by a query are kept for the next ones on the same image, Reset() starts over with
+ * the regions of another image. The recognition itself is left to a reader, which is handed batches of regions.
+ * Not thread-safe, calls must be serialized by the caller.
+ */
+class LazyRecognizer {
+ public:
+  /**
+   * @brief Recognizes a batch of regions, returns the words read in them.
+   */
+  using Reader = std::function<std::vector<DetectReadResult>(const std::vector<TextDetectionResult> &regions)>;
+
+  /**
+   * @brief Constructs a recognizer without regions.
+   */
+  LazyRecognizer();
+
+  /**
+   * @brief Replaces the regions with those of another image, the words read so far are dropped.
+   *
+   * @details The position of the previous match is kept, consecutive images often hold the same target at the same
+   * place.
+   *
+   * @param regions The regions detected in the image.
+   */
+  auto Reset(std::vector<TextDetectionResult> regions = {}) -> void;
+
+  /**
+   * @brief Forgets the position of the previous match.
+   */
+  auto ClearLastHit() noexcept -> void;
+
+  /**
+   * @brief Matches a target, reading the regions most likely to hold it until it matches well enough.
+   *
+   * @param target The target text.
+   * @param image_size The size of the image the regions were detected in.
+   * @param batch_size Number of regions handed to the reader at once, 0 counts as 1.
+   * @param min_score Match score ending the search.
+   * @param read The reader recognizing the regions.
+   * @return The best match among the words read so far.
+   */
+  auto Match(std::string_view target, const cv::Size &image_size, std::size_t batch_size, float min_score,
+             const Reader &read) -> MatchResult;
+
+  /**
+   * @brief Reads every region not read yet, in a single batch.
+   */
+  auto ReadAll(const Reader &read) -> void;
+
+  /**
+   * @brief Gets the words read so far.
+   */
+  auto GetResults() const noexcept -> const std::vector<DetectReadResult> & { return results_; }
+
+  /**
+   * @brief Gets the index of the words read so far.
+   */
+  auto GetIndex() const noexcept -> const TextIndex & { return index_; }
+
+  /**
+   * @brief Gets the number of regions of the image.
+   */
+  auto NumRegions() const noexcept -> std::size_t { return regions_.size(); }
+
+  /**
+   * @brief Gets the number of regions read so far.
+   */
+  auto NumReadRegions() const noexcept -> std::size_t { return num_read_; }
+
+ private:
+  /**
+   * @brief Gets the positions in regions_ of the regions not read yet.
+   */
+  auto GetUnreadRegions() const -> std::vector<std::size_t>;
+
+  /**
+   * @brief Reads the given regions and indexes their words.
+   */
+  auto Read(const std::vector<std::size_t> &indices, const Reader &read) -> void;
+
+  std::vector<TextDetectionResult> regions_;  // Regions detected in the image.
+  std::vector<bool> read_;                    // Whether every region of regions_ is read.
+  std::size_t num_read_;                      // Number of regions read.
+  std::vector<DetectReadResult> results_;     // Words read so far.
+  TextIndex index_;                           // Index of the words of results_.
+  cv::Point last_hit_;                        // Position of the previous match.
+};
@@ -0,0 +1,223 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Names of the stages timed by the detect and read pipeline.
+ */
+inline constexpr std::string_view kStageLoad = "load";                 // Decoding or copying the image.
+inline constexpr std::string_view kStageDetectRead = "detect_read";    // A whole DetectRead() call.
+inline constexpr std::string_view kStagePreprocess = "preprocess";     // Preparing the image for recognition.
+inline constexpr std::string_view kStageDetect = "detect";             // Detecting the text regions.
+inline constexpr std::string_view kStageEastForward = "east_forward";  // Forward pass of the EAST network.
+inline constexpr std::string_view kStageEastDecode = "east_decode";    // Decoding and non-maximum suppression.
+inline constexpr std::string_view kStageOcr = "ocr";                   // Recognizing one region.
+inline constexpr std::string_view kStageMatch = "match";               // Matching target texts.
+
+/**
+ * @brief Names of the counters of the detect and read pipeline.
+ */
+inline constexpr std::string_view kCounterImages = "images";                 // Images processed.
+inline constexpr std::string_view kCounterBoxes = "boxes";                   // Text regions detected.
+inline constexpr std::string_view kCounterRegions = "regions";               // Regions recognized, after merging.
+inline constexpr std::string_view kCounterDuplicates = "duplicates";         // Words dropped as duplicates.
+inline constexpr std::string_view kCounterWords = "words";                   // Words recognized.
+inline constexpr std::string_view kCounterCacheHits = "ocr_cache_hits";      // Regions found in the OCR cache.
+inline constexpr std::string_view kCounterCacheMisses = "ocr_cache_misses";  // Regions missing from the OCR cache.
+
+/**
+ * @enum MetricsFormat
+ * @brief Text formats the metrics can be exported to.
+ */
+enum class MetricsFormat {
+  kJson,        // A JSON object of counters and histograms.
+  kPrometheus,  // The Prometheus text exposition format.
+};
+
+/**
+ * @class Histogram
+ * @brief Distribution of durations, in exponential buckets from 10 microseconds to about 40 seconds.
+ *
+ * @details Recording is constant time and memory, the quantiles are interpolated within a bucket, so they are
+ * accurate to a factor of 2 at worst.
+ */
+class Histogram {
+ public:
+  /**
+   * @brief Number of buckets, the last one holds the durations above every bound.
+   */
+  static constexpr std::size_t kNumBuckets = 24;
+
+  /**
+   * @brief Gets the upper bound of a bucket, in seconds.
+   */
+  static auto GetBucketBound(std::size_t bucket) noexcept -> double;
+
+  /**
+   * @brief Records a duration.
+   *
+   * @param seconds The duration, in seconds.
+   */
+  auto Record(double seconds) noexcept -> void;
+
+  /**
+   * @brief Gets the number of recorded durations.
+   */
+  auto GetCount() const noexcept -> std::uint64_t { return count_; }
+
+  /**
+   * @brief Gets the sum of the recorded durations, in seconds.
+   */
+  auto GetSum() const noexcept -> double { return sum_; }
+
+  /**
+   * @brief Gets the shortest recorded duration, 0 if there is none.
+   */
+  auto GetMin() const noexcept -> double { return count_ == 0 ? 0.0 : min_; }
+
+  /**
+   * @brief Gets the longest recorded duration, 0 if there is none.
+   */
+  auto GetMax() const noexcept -> double { return max_; }
+
+  /**
+   * @brief Gets the mean of the recorded durations, 0 if there is none.
+   */
+  auto GetMean() const noexcept -> double { return count_ == 0 ? 0.0 : sum_ / static_cast<double>(count_); }
+
+  /**
+   * @brief Estimates a quantile of the recorded durations.
+   *
+   * @param q The quantile, in [0, 1].
+   * @return The estimated duration, in seconds, 0 if there is none.
+   */
+  auto GetQuantile(double q) const noexcept -> double;
+
+  /**
+   * @brief Gets the number of durations recorded in each bucket.
+   */
+  auto GetBuckets() const noexcept -> const std::array<std::uint64_t, kNumBuckets> & { return buckets_; }
+
+ private:
+  std::array<std::uint64_t, kNumBuckets> buckets_{};  // Number of durations per bucket.
+  std::uint64_t count_ = 0;                           // Number of durations.
+  double sum_ = 0.0;                                  // Sum of the durations.
+  double min_ = 0.0;                                  // Shortest duration.
+  double max_ = 0.0;                                  // Longest duration.
+};
+
+/**
+ * @class Metrics
+ * @brief Named duration histograms and counters of the detect and read pipeline.
+ *
+ * @details Handed to the pipeline through DetectReadOptions::metrics_, or enabled on a TextSpotter, it records the
+ * time spent in every stage and counts the detected boxes, the recognized words and the cache lookups. The metrics can
+ * be queried or exported as JSON or in the Prometheus text format, to compare runs and tune the thread counts. All
+ * methods are thread-safe.
+ */
+class Metrics {
+ public:
+  /**
+   * @brief Records a duration in the histogram of a stage, created on first use.
+   *
+   * @param stage The name of the stage.
+   * @param seconds The duration, in seconds.
+   */
+  auto Record(std::string_view stage, double seconds) -> void;
+
+  /**
+   * @brief Adds to a counter, created on first use.
+   *
+   * @param counter The name of the counter.
+   * @param value The value added (default: 1).
+   */
+  auto Increment(std::string_view counter, std::uint64_t value = 1) -> void;
+
+  /**
+   * @brief Gets a copy of the histogram of a stage, empty if the stage never ran.
+   */
+  auto GetHistogram(std::string_view stage) const -> Histogram;
+
+  /**
+   * @brief Gets the value of a counter, 0 if it was never incremented.
+   */
+  auto GetCounter(std::string_view counter) const -> std::uint64_t;
+
+  /**
+   * @brief Gets a copy of every histogram, sorted by stage name.
+   */
+  auto GetHistograms() const -> std::vector<std::pair<std::string, Histogram>>;
+
+  /**
+   * @brief Gets every counter, sorted by name.
+   */
+  auto GetCounters() const -> std::vector<std::pair<std::string, std::uint64_t>>;
+
+  /**
+   * @brief Removes every histogram and counter.
+   */
+  auto Reset() -> void;
+
+  /**
+   * @brief Exports the metrics as text.
+   *
+   * @param format The text format.
+   * @return The exported metrics.
+   */
+  auto Export(MetricsFormat format) const -> std::string;
+
+  /**
+   * @brief Exports the metrics to a file.
+   *
+   * @param path The path of the file, overwritten if it exists.
+   * @param format The text format.
+   * @return True on success.
+   */
+  auto Save(std::string_view path, MetricsFormat format) const -> bool;
+
+ private:
+  std::map<std::string, Histogram, std::less<>> histograms_;    // Histograms by stage name.
+  std::map<std::string, std::uint64_t, std::less<>> counters_;  // Counters by name.
+  mutable std::mutex mutex_;                                    // Guards all members.
+};
+
+/**
+ * @class StageTimer
+ * @brief Records the time spent in a scope in the histogram of a stage.
+ *
+ * @details Does nothing, not even reading the clock, when the metrics are nullptr, so the instrumentation costs
+ * nothing when it is disabled.
+ */
+class StageTimer {
+ public:
+  /**
+   * @brief Starts timing a stage.
+   *
+   * @param metrics The metrics the duration is recorded in, may be nullptr.
+   * @param stage The name of the stage, must outlive the timer.
+   */
+  StageTimer(Metrics *metrics, std::string_view stage) noexcept;
+
+  StageTimer(const StageTimer &) = delete;
+  auto operator=(const StageTimer &) -> StageTimer & = delete;
+
+  /**
+   * @brief Records the time elapsed since construction.
+   */
+  ~StageTimer();
+
+ private:
+  Metrics *metrics_;                             // Where the duration is recorded, may be nullptr.
+  std::string_view stage_;                       // The name of the stage.
+  std::chrono::steady_clock::time_point start_;  // When the timer was constructed.
+};
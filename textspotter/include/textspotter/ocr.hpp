@@ -2,12 +2,87 @@
 
 #include <tesseract/baseapi.h>
 
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <mutex>
 #include <opencv2/core.hpp>
 #include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
 
 #include "textspotter/result_type.hpp"
 
+/**
+ * @struct RecognitionProfile
+ * @brief How a Tesseract engine segments and recognizes the regions it is given.
+ *
+ * @details The detected regions already hold a line or a word of text, yet the default page segmentation still looks
+ * for blocks, columns and lines in every one of them. SingleLine() and SingleWord() skip this layout analysis, which
+ * is most of the recognition time of a small region. The profile is applied when an engine is initialized.
+ */
+struct RecognitionProfile {
+  /**
+   * @brief How the engine splits a region into lines and words.
+   */
+  tesseract::PageSegMode page_seg_mode_ = tesseract::PSM_SINGLE_BLOCK;
+
+  /**
+   * @brief Which recognizer runs, OEM_LSTM_ONLY skips the legacy engine.
+   */
+  tesseract::OcrEngineMode engine_mode_ = tesseract::OEM_DEFAULT;
+
+  /**
+   * @brief Whether the word lists of the language are loaded to correct the recognized words.
+   *
+   * @details Turn off for text that is not made of words, e.g. codes or numbers.
+   */
+  bool load_dictionaries_ = true;
+
+  /**
+   * @brief Whether words missing from the word lists score lower, only used by the legacy engine.
+   */
+  bool penalize_non_dictionary_words_ = true;
+
+  /**
+   * @brief The only characters the engine may recognize, empty means every character of the language.
+   */
+  std::string char_whitelist_;
+
+  /**
+   * @brief Gets the profile of a plain engine: the whole region is segmented like a block of text.
+   */
+  static auto Default() -> RecognitionProfile;
+
+  /**
+   * @brief Gets a profile treating each region as a single line of text, recognized by the LSTM engine only.
+   *
+   * @details The best choice for the regions of the EAST detector, which hold one line of one or more words.
+   */
+  static auto SingleLine() -> RecognitionProfile;
+
+  /**
+   * @brief Gets a profile treating each region as a single word, recognized by the LSTM engine only.
+   *
+   * @details Words run together when a region holds several of them, only use it on regions known to hold one word.
+   */
+  static auto SingleWord() -> RecognitionProfile;
+
+  /**
+   * @brief Gets a profile treating each region as a raw line, without the word lists nor any text-specific hack.
+   *
+   * @details The fastest profile, meant for text that is not made of dictionary words.
+   */
+  static auto RawLine() -> RecognitionProfile;
+
+  /**
+   * @brief Gets a hash of the profile, two profiles with the same settings have the same key.
+   */
+  auto GetKey() const noexcept -> std::uint64_t;
+};
+
 /**
  * @function RecognizeText
  * @brief Recognizes and extracts text from an image using OCR (Optical Character Recognition).
@@ -26,6 +101,27 @@
 auto RecognizeText(const cv::Mat &image, float conf_threshold, std::optional<cv::Rect> roi = std::nullopt) noexcept
     -> std::vector<OcrResult>;
 
+class TesseractApi;
+
+/**
+ * @function RecognizeText
+ * @brief Recognizes and extracts text from an image using an already initialized Tesseract engine.
+ *
+ * @details Unlike the overload above, this function does not construct a new engine, so the language data is not
+ * reloaded on every call. The engine must not be used by another thread at the same time.
+ *
+ * @param tesseract The initialized Tesseract engine used for recognition.
+ * @param image The image (cv::Mat) from which text is to be recognized.
+ * @param conf_threshold The confidence threshold for the OCR process.
+ * @param roi Optional region of interest within the image. Only the pixels of the region are handed to the engine, so
+ * the cost of a call follows the size of the region rather than of the image. Defaults to std::nullopt (whole image).
+ * @return A vector of OcrResult, each containing recognized text, its bounding rectangle in image coordinates, and
+ * confidence score.
+ * @throws This function is noexcept and does not throw exceptions.
+ */
+auto RecognizeText(TesseractApi &tesseract, const cv::Mat &image, float conf_threshold,
+                   std::optional<cv::Rect> roi = std::nullopt) noexcept -> std::vector<OcrResult>;
+
 /**
  * @class TesseractApi
  * @brief Encapsulates the Tesseract OCR API for text recognition.
@@ -42,8 +138,11 @@ class TesseractApi {
    * If no language is specified, it defaults to English ("eng").
    *
    * @param language The language code for OCR. Defaults to "eng" (English) if not specified.
+   * @param profile How the engine segments and recognizes the regions. Defaults to RecognitionProfile::Default().
+   * @throws std::runtime_error if the engine cannot be initialized, e.g. when the language data of the profile's
+   * engine mode is missing.
    */
-  explicit TesseractApi(const char *language = "eng");
+  explicit TesseractApi(const char *language = "eng", const RecognitionProfile &profile = {});
 
   /**
    * @brief Destroys the TesseractApi instance.
@@ -52,14 +151,22 @@ class TesseractApi {
    */
   ~TesseractApi();
 
+  /**
+   * @brief Gets a hash of the configuration of the engine.
+   *
+   * @details Covers the languages and the recognition profile. Two engines with the same key produce the same text for
+   * the same pixels, the key is part of the keys of an OcrCache.
+   */
+  auto GetConfigKey() const noexcept -> std::uint64_t { return config_key_; }
+
   /**
    * @brief Grants the RecognizeText function access to the private members of TesseractApi.
    *
    * @details This friend declaration allows the RecognizeText function to access the private
    * members of the TesseractApi class, such as the Tesseract engine instance, for text recognition purposes.
    */
-  friend auto RecognizeText(const cv::Mat &image, float conf_threshold, std::optional<cv::Rect> roi) noexcept
-      -> std::vector<OcrResult>;
+  friend auto RecognizeText(TesseractApi &tesseract, const cv::Mat &image, float conf_threshold,
+                            std::optional<cv::Rect> roi) noexcept -> std::vector<OcrResult>;
 
  private:
   /**
@@ -68,4 +175,107 @@ class TesseractApi {
    * @details This pointer holds and manages the Tesseract OCR engine instance used for text recognition.
    */
   std::unique_ptr<tesseract::TessBaseAPI> api_;
+
+  /**
+   * @brief Hash of the configuration of the engine.
+   */
+  std::uint64_t config_key_;
+};
+
+/**
+ * @class TesseractPool
+ * @brief A thread-safe pool of initialized Tesseract engines.
+ *
+ * @details Initializing a Tesseract engine loads the language data from disk, which is far more expensive than
+ * recognizing a small text region. The pool keeps engines alive so that they can be reused across regions and frames.
+ * Engines are created lazily on first demand, up to the configured pool size, and are checked out through RAII
+ * handles that return them to the pool when destroyed. When all engines are checked out, Acquire() blocks until one
+ * is returned.
+ */
+class TesseractPool {
+ public:
+  /**
+   * @class Handle
+   * @brief RAII handle to an engine checked out from a TesseractPool.
+   */
+  class Handle {
+   public:
+    Handle(TesseractPool *pool, std::unique_ptr<TesseractApi> api) noexcept;
+    Handle(Handle &&other) noexcept;
+    Handle(const Handle &) = delete;
+    auto operator=(Handle &&other) noexcept -> Handle &;
+    auto operator=(const Handle &) -> Handle & = delete;
+
+    /**
+     * @brief Returns the engine to the pool.
+     */
+    ~Handle();
+
+    auto operator*() const noexcept -> TesseractApi & { return *api_; }
+    auto operator->() const noexcept -> TesseractApi * { return api_.get(); }
+
+   private:
+    TesseractPool *pool_;
+    std::unique_ptr<TesseractApi> api_;
+  };
+
+  /**
+   * @brief Constructs an empty pool, no engine is initialized until it is first acquired.
+   *
+   * @param size Maximum number of engines in the pool, 0 means std::thread::hardware_concurrency().
+   * @param language The language code used to initialize the engines. Defaults to "eng" (English).
+   * @param profile How the engines segment and recognize the regions. Defaults to RecognitionProfile::Default().
+   */
+  explicit TesseractPool(std::size_t size = 0, std::string_view language = "eng", RecognitionProfile profile = {});
+
+  TesseractPool(const TesseractPool &) = delete;
+  auto operator=(const TesseractPool &) -> TesseractPool & = delete;
+
+  ~TesseractPool() = default;
+
+  /**
+   * @brief Checks out an engine, initializing a new one if none is idle and the pool is not full.
+   *
+   * @return A handle to the checked out engine.
+   * @throws std::runtime_error if a new engine cannot be initialized.
+   */
+  auto Acquire() -> Handle;
+
+  /**
+   * @brief Eagerly initializes engines until the pool is full.
+   *
+   * @throws std::runtime_error if an engine cannot be initialized.
+   */
+  auto Warmup() -> void;
+
+  /**
+   * @brief Gets the maximum number of engines in the pool.
+   */
+  auto Size() const noexcept -> std::size_t { return size_; }
+
+  /**
+   * @brief Gets the language the engines are initialized with.
+   */
+  auto GetLanguage() const noexcept -> const std::string & { return language_; }
+
+  /**
+   * @brief Gets the recognition profile of the engines.
+   */
+  auto GetRecognitionProfile() const noexcept -> const RecognitionProfile & { return profile_; }
+
+  /**
+   * @brief Gets the process-wide pool shared by the free detect and read functions.
+   */
+  static auto Global() -> TesseractPool &;
+
+ private:
+  auto Release(std::unique_ptr<TesseractApi> api) noexcept -> void;
+
+  std::size_t size_;                                 // Maximum number of engines.
+  std::string language_;                             // Language used to initialize engines.
+  RecognitionProfile profile_;                       // Recognition profile used to initialize engines.
+  std::size_t created_;                              // Number of engines created or being created.
+  std::vector<std::unique_ptr<TesseractApi>> idle_;  // Engines not checked out.
+  std::mutex mutex_;
+  std::condition_variable cv_;
 };
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <opencv2/core.hpp>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "textspotter/result_type.hpp"
+
+/**
+ * @class OcrCache
+ * @brief A least recently used cache of OCR results, keyed by a hash of the recognized pixels.
+ *
+ * @details The same widgets (buttons, menu entries, labels) show up again and again across frames and runs. Hashing
+ * the preprocessed pixels of a region, together with the configuration of the engine, identifies a region that was
+ * already recognized, whose text can then be returned without running the engine. The bounding boxes of the cached
+ * results are relative to the region, so a widget that moved is still a hit.
+ *
+ * The cache is bounded by an approximate memory budget, the least recently used entries are evicted first. It can be
+ * saved to and loaded from a file to be shared between runs. All methods are thread-safe.
+ */
+class OcrCache {
+ public:
+  /**
+   * @brief Constructs an empty cache.
+   *
+   * @param capacity_bytes Approximate memory budget of the cached results, defaults to 16 MiB.
+   */
+  explicit OcrCache(std::size_t capacity_bytes = 16 * 1024 * 1024);
+
+  /**
+   * @brief Looks up the results of a region and marks them as recently used.
+   *
+   * @param key The key of the region, see MakeKey().
+   * @return The cached results, relative to the region, or std::nullopt on a miss.
+   */
+  auto Find(std::uint64_t key) -> std::optional<std::vector<OcrResult>>;
+
+  /**
+   * @brief Inserts or replaces the results of a region, evicting older entries if the budget is exceeded.
+   *
+   * @param key The key of the region, see MakeKey().
+   * @param results The results, relative to the region.
+   */
+  auto Insert(std::uint64_t key, std::vector<OcrResult> results) -> void;
+
+  /**
+   * @brief Removes every entry, the hit and miss counters are kept.
+   */
+  auto Clear() -> void;
+
+  /**
+   * @brief Gets the number of successful lookups.
+   */
+  auto GetHits() const noexcept -> std::size_t;
+
+  /**
+   * @brief Gets the number of failed lookups.
+   */
+  auto GetMisses() const noexcept -> std::size_t;
+
+  /**
+   * @brief Gets the number of cached regions.
+   */
+  auto Size() const noexcept -> std::size_t;
+
+  /**
+   * @brief Gets the approximate memory used by the cached results, in bytes.
+   */
+  auto GetMemoryUsage() const noexcept -> std::size_t;
+
+  /**
+   * @brief Saves the entries to a file, from the least to the most recently used.
+   *
+   * @param path The path of the file, overwritten if it exists.
+   * @return True on success.
+   */
+  auto Save(std::string_view path) const -> bool;
+
+  /**
+   * @brief Loads the entries of a file saved by Save(), in addition to the current ones.
+   *
+   * @param path The path of the file.
+   * @return True on success, false if the file cannot be read or is not a cache file.
+   */
+  auto Load(std::string_view path) -> bool;
+
+  /**
+   * @brief Computes the key of a region from its pixels and the configuration of the engine.
+   *
+   * @param region The pixels handed to the engine, may be a view into a larger image.
+   * @param config_key A hash of the engine configuration, see TesseractApi::GetConfigKey().
+   * @return The key of the region.
+   */
+  static auto MakeKey(const cv::Mat &region, std::uint64_t config_key) noexcept -> std::uint64_t;
+
+  /**
+   * @brief Hashes a byte sequence, used to build the keys.
+   *
+   * @param data The bytes to hash.
+   * @param size The number of bytes.
+   * @param seed The initial value of the hash.
+   * @return The hash.
+   */
+  static auto HashBytes(const void *data, std::size_t size, std::uint64_t seed) noexcept -> std::uint64_t;
+
+ private:
+  using Entry = std::pair<std::uint64_t, std::vector<OcrResult>>;
+
+  /**
+   * @brief Gets the approximate memory used by an entry.
+   */
+  static auto EntrySize(const Entry &entry) noexcept -> std::size_t;
+
+  /**
+   * @brief Inserts an entry and evicts the least recently used ones, the mutex must be held.
+   */
+  auto InsertLocked(std::uint64_t key, std::vector<OcrResult> results) -> void;
+
+  std::size_t capacity_bytes_;                                           // Memory budget.
+  std::size_t used_bytes_;                                               // Memory used by the entries.
+  std::size_t hits_;                                                     // Number of hits.
+  std::size_t misses_;                                                   // Number of misses.
+  std::list<Entry> entries_;                                             // Most recently used first.
+  std::unordered_map<std::uint64_t, std::list<Entry>::iterator> index_;  // Entries by key.
+  mutable std::mutex mutex_;                                             // Guards all members.
+};
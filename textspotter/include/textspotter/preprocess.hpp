@@ -0,0 +1,203 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <opencv2/core.hpp>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @struct StageTiming
+ * @brief Accumulated running time of a preprocessing stage.
+ */
+struct StageTiming {
+  /**
+   * @brief The name of the stage.
+   */
+  std::string name_;
+
+  /**
+   * @brief Total time spent in the stage, in seconds.
+   */
+  double total_seconds_;
+
+  /**
+   * @brief Number of times the stage ran.
+   */
+  std::size_t calls_;
+};
+
+/**
+ * @class PreprocessPipeline
+ * @brief An ordered list of named image processing stages applied before recognition.
+ *
+ * @details Each stage reads the output of the previous one and writes a new image. The default profile reproduces
+ * Preprocess(): grayscale, invert, 5x5 Gaussian blur, adaptive threshold and non-local means denoising. The fast
+ * profile replaces the denoising, by far the most expensive stage, with a 3x3 median blur, which is enough for clean
+ * screenshots. The running time of every stage is accumulated and can be queried to choose a profile.
+ *
+ * Run() may be called concurrently, stages must not be added or removed at the same time.
+ */
+class PreprocessPipeline {
+ public:
+  /**
+   * @brief A stage reads its input image and writes its output image, the two never share pixels.
+   */
+  using Stage = std::function<void(const cv::Mat &input, cv::Mat &output)>;
+
+  /**
+   * @brief Constructs an empty pipeline, which returns its input unchanged.
+   */
+  PreprocessPipeline();
+
+  /**
+   * @brief Moves the stages and their timings, the moved-from pipeline is left empty.
+   */
+  PreprocessPipeline(PreprocessPipeline &&other) noexcept;
+  auto operator=(PreprocessPipeline &&other) noexcept -> PreprocessPipeline &;
+
+  ~PreprocessPipeline() = default;
+
+  /**
+   * @brief Appends a stage to the pipeline.
+   *
+   * @param name The name of the stage, used to remove it and to report its timing.
+   * @param stage The stage.
+   * @return The pipeline, so that calls can be chained.
+   */
+  auto AddStage(std::string_view name, Stage stage) -> PreprocessPipeline &;
+
+  /**
+   * @brief Removes every stage with the given name.
+   *
+   * @param name The name of the stage.
+   * @return True if a stage was removed.
+   */
+  auto RemoveStage(std::string_view name) -> bool;
+
+  /**
+   * @brief Gets the names of the stages, in order.
+   */
+  auto GetStageNames() const -> std::vector<std::string>;
+
+  /**
+   * @brief Applies the stages to an image.
+   *
+   * @param image The image to process, it is never modified.
+   * @return The processed image.
+   */
+  auto Run(const cv::Mat &image) const -> cv::Mat;
+
+  /**
+   * @brief Gets the accumulated running time of every stage, in stage order.
+   */
+  auto GetStageTimings() const -> std::vector<StageTiming>;
+
+  /**
+   * @brief Resets the accumulated running times.
+   */
+  auto ResetStageTimings() -> void;
+
+  /**
+   * @brief Builds the default profile, equivalent to Preprocess().
+   */
+  static auto Default() -> PreprocessPipeline;
+
+  /**
+   * @brief Builds the fast profile, with a median blur instead of non-local means denoising.
+   */
+  static auto Fast() -> PreprocessPipeline;
+
+  /**
+   * @name Stages
+   * @brief Building blocks of the profiles.
+   * @{
+   */
+  static auto Grayscale() -> Stage;
+  static auto Invert() -> Stage;
+  static auto GaussianBlur(int kernel_size = 5) -> Stage;
+  static auto AdaptiveThreshold(int block_size = 5, double c = 3) -> Stage;
+  static auto NlMeansDenoise(float h = 3) -> Stage;
+  static auto MedianBlur(int kernel_size = 3) -> Stage;
+  static auto BilateralFilter(int diameter = 5, double sigma_color = 50, double sigma_space = 50) -> Stage;
+  /** @} */
+
+ private:
+  std::vector<std::pair<std::string, Stage>> stages_;  // Named stages, in order.
+  mutable std::vector<StageTiming> timings_;           // Accumulated timing of each stage.
+  mutable std::mutex timings_mutex_;                   // Guards timings_ when Run() is called concurrently.
+};
+
+/**
+ * @class LazyPreprocessor
+ * @brief Preprocesses only the parts of an image that are actually recognized.
+ *
+ * @details Preprocessing the whole image is wasted work when the detector found a few small text regions. The image is
+ * split into a grid of tiles, a tile is preprocessed (together with a margin of surrounding pixels, so that the
+ * filters see the same neighbourhood as on the whole image) the first time a region overlapping it is requested, and
+ * the result is written into a shared canvas. Overlapping regions share the tiles already computed.
+ *
+ * Prepare() may be called concurrently, every tile is computed exactly once.
+ */
+class LazyPreprocessor {
+ public:
+  /**
+   * @brief Constructs a lazy preprocessor, no pixel is processed until a region is prepared.
+   *
+   * @param image The image to preprocess. The pixels are not copied, the image must outlive the preprocessor.
+   * @param tile_size Width and height of a tile in pixels, defaults to 128.
+   * @param margin Number of surrounding pixels processed with each tile, defaults to 24.
+   */
+  explicit LazyPreprocessor(const cv::Mat &image, int tile_size = 128, int margin = 24);
+
+  /**
+   * @brief Constructs a lazy preprocessor running the given pipeline on each tile.
+   *
+   * @param image The image to preprocess. The pixels are not copied, the image must outlive the preprocessor.
+   * @param pipeline The pipeline applied to each tile, it must outlive the preprocessor. The margin must cover the
+   * footprint of its filters.
+   * @param tile_size Width and height of a tile in pixels, defaults to 128.
+   * @param margin Number of surrounding pixels processed with each tile, defaults to 24.
+   */
+  LazyPreprocessor(const cv::Mat &image, const PreprocessPipeline &pipeline, int tile_size = 128, int margin = 24);
+
+  /**
+   * @brief Preprocesses the tiles overlapping a region, if not already done.
+   *
+   * @param roi The region of interest, in image coordinates.
+   * @return A view of the preprocessed region, clipped to the image.
+   */
+  auto Prepare(const cv::Rect &roi) -> cv::Mat;
+
+  /**
+   * @brief Gets the preprocessed canvas, only the prepared regions hold meaningful pixels.
+   */
+  auto GetCanvas() const noexcept -> const cv::Mat & { return processed_; }
+
+  /**
+   * @brief Gets the number of tiles processed so far.
+   */
+  auto NumProcessedTiles() const noexcept -> std::size_t { return processed_tiles_; }
+
+ private:
+  LazyPreprocessor(const cv::Mat &image, const PreprocessPipeline *pipeline, int tile_size, int margin);
+
+  /**
+   * @brief Preprocesses one tile and writes it into the canvas.
+   */
+  auto ProcessTile(int tile_x, int tile_y) -> void;
+
+  const PreprocessPipeline *pipeline_;        // The pipeline applied to each tile, nullptr for Preprocess().
+  cv::Mat image_;                             // The source image.
+  cv::Mat processed_;                         // Canvas holding the processed tiles.
+  int tile_size_;                             // Width and height of a tile.
+  int margin_;                                // Pixels processed around each tile.
+  int tiles_x_;                               // Number of tile columns.
+  int tiles_y_;                               // Number of tile rows.
+  std::unique_ptr<std::once_flag[]> once_;    // One flag per tile, row major.
+  std::atomic<std::size_t> processed_tiles_;  // Number of processed tiles.
+};
@@ -23,6 +23,14 @@ struct TextDetectionResult {
    * region contains text. Higher values indicate greater confidence.
    */
   float conf_;
+
+  /**
+   * @brief The rotated box of the detected text, as predicted by the detector.
+   *
+   * @details bounding_box_ is an axis-aligned approximation of this box. For slanted text, the rotated box is much
+   * tighter and can be rectified into an upright crop before recognition, see RectifyRegion.
+   */
+  cv::RotatedRect rotated_box_;
 };
 
 /**
@@ -69,4 +77,28 @@ struct DetectReadResult {
    * @brief The bounding box of the detected and read text within the image.
    */
   cv::Rect bounding_box_;
+
+  /**
+   * @brief The confidence of the recognition, from 0 to 100, as reported by the OCR engine.
+   */
+  float conf_ = 0.0F;
+};
+
+/**
+ * @struct MatchResult
+ * @brief Represents the result of matching a target text against the detected and read text.
+ */
+struct MatchResult {
+  /**
+   * @brief The center of the matched text, {-1, -1} if the target was not found.
+   */
+  cv::Point point_;
+
+  /**
+   * @brief How closely the matched text reads like the target, in (0, 1], or 0 if the target was not found.
+   *
+   * @details The mean over the words of the target of 1 minus the edit distance to the matched word, divided by the
+   * length of the longer of the two.
+   */
+  float score_;
 };
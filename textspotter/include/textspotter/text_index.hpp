@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "textspotter/result_type.hpp"
+
+/**
+ * @class TextIndex
+ * @brief A fuzzy index of the words of a set of detections, answering IsMatch() queries without comparing them all.
+ *
+ * @details Detections sharing the same word up to case are stored once, and the distinct words are sorted by length.
+ * Two words can only match when their distance is below half the length of the shorter one, so a query only visits
+ * the words of compatible lengths. A signature of the characters of every word gives a lower bound of the distance
+ * in a couple of instructions, which discards most of the remaining words before the query, compiled once, is
+ * compared with the others. A query returns exactly the detections a linear scan would.
+ *
+ * The index does not keep a reference to the detections it was built from.
+ */
+class TextIndex {
+ public:
+  /**
+   * @struct Match
+   * @brief A detection matching a query.
+   */
+  struct Match {
+    std::size_t detection_;  // Position of the detection.
+    float similarity_;       // 1 minus the edit distance divided by the length of the longer word, in (0, 1].
+  };
+
+  /**
+   * @brief Constructs an empty index.
+   */
+  TextIndex() = default;
+
+  /**
+   * @brief Constructs an index of the words of the detections.
+   *
+   * @param detections The detections, identified by their position in the vector.
+   */
+  explicit TextIndex(const std::vector<DetectReadResult> &detections);
+
+  /**
+   * @brief Replaces the content of the index with the words of the detections.
+   *
+   * @param detections The detections, identified by their position in the vector.
+   */
+  auto Build(const std::vector<DetectReadResult> &detections) -> void;
+
+  /**
+   * @brief Removes every word from the index.
+   */
+  auto Clear() noexcept -> void;
+
+  /**
+   * @brief Finds the detections whose word matches the target, as IsMatch() with case-insensitive comparison.
+   *
+   * @param target The word to look for.
+   * @return The positions of the matching detections, in ascending order.
+   */
+  auto Find(std::string_view target) const -> std::vector<std::size_t>;
+
+  /**
+   * @brief Finds the detections whose word matches the target, together with the similarity of the words.
+   *
+   * @param target The word to look for.
+   * @return The matching detections, in ascending order of position.
+   */
+  auto FindMatches(std::string_view target) const -> std::vector<Match>;
+
+  /**
+   * @brief Gets the number of indexed detections.
+   */
+  auto Size() const noexcept -> std::size_t;
+
+  /**
+   * @brief Gets the number of distinct words, up to case.
+   */
+  auto GetNumWords() const noexcept -> std::size_t;
+
+ private:
+  /**
+   * @struct Entry
+   * @brief A distinct word and the detections reading it.
+   */
+  struct Entry {
+    std::string word_;                     // The word in lower case.
+    std::uint64_t signature_;              // One bit per character of the word, hashed into 64 bits.
+    std::vector<std::size_t> detections_;  // Positions of the detections reading the word.
+  };
+
+  /**
+   * @brief Computes the signature of a word, a character of one word missing from the other costs at least one edit.
+   */
+  static auto Signature(std::string_view word) noexcept -> std::uint64_t;
+
+  std::vector<Entry> entries_;  // The distinct words, sorted by length.
+  std::size_t size_ = 0;        // Number of indexed detections.
+};
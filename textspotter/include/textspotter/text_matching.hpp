@@ -2,9 +2,14 @@
 
 #include <opencv2/core.hpp>
 #include <string>
+#include <string_view>
+#include <vector>
 
 #include "textspotter/result_type.hpp"
 
+class TextIndex;
+class ThreadPool;
+
 /**
  * @brief Compares two strings for a match, optionally case-sensitive.
  *
@@ -24,6 +29,17 @@ auto IsMatch(std::string_view s1, std::string_view s2, bool case_sensitive = fal
  */
 auto MatchWord(const std::vector<DetectReadResult> &detections, std::string_view target) noexcept -> cv::Point;
 
+/**
+ * @brief Matches a target word in the list of text detections using an index of their words.
+ *
+ * @param detections A vector of DetectReadResult objects representing detected and recognized text regions.
+ * @param index The index built from the detections.
+ * @param target The target word to match.
+ * @return The position of the first detection matching the word as a cv::Point, {-1, -1} if there is none.
+ */
+auto MatchWord(const std::vector<DetectReadResult> &detections, const TextIndex &index,
+               std::string_view target) noexcept -> cv::Point;
+
 /**
  * @brief Matches a list of target words in the list of text detections and returns the position of the first match
  * found.
@@ -34,3 +50,41 @@ auto MatchWord(const std::vector<DetectReadResult> &detections, std::string_view
  */
 auto MatchWordGroups(const std::vector<DetectReadResult> &detections, const std::vector<std::string> &target) noexcept
     -> cv::Point;
+
+/**
+ * @brief Matches a list of target words in the list of text detections using an index of their words.
+ *
+ * @param detections A vector of DetectReadResult objects representing detected and recognized text regions.
+ * @param index The index built from the detections.
+ * @param target A vector of target words to match.
+ * @return The center of the closest group of detections matching the target words, {-1, -1} if there is none.
+ */
+auto MatchWordGroups(const std::vector<DetectReadResult> &detections, const TextIndex &index,
+                     const std::vector<std::string> &target) noexcept -> cv::Point;
+
+/**
+ * @brief Matches a target text, one or several words, using an index of the words of the detections.
+ *
+ * @param detections A vector of DetectReadResult objects representing detected and recognized text regions.
+ * @param index The index built from the detections.
+ * @param target The target text to match.
+ * @return The center of the matched text and how closely it reads like the target.
+ */
+auto MatchTarget(const std::vector<DetectReadResult> &detections, const TextIndex &index,
+                 std::string_view target) noexcept -> MatchResult;
+
+/**
+ * @brief Matches many target texts at once using an index of the words of the detections.
+ *
+ * @details A word shared by several targets is looked up once. The lookups, then the targets, are spread over the
+ * workers of the thread pool if one is given.
+ *
+ * @param detections A vector of DetectReadResult objects representing detected and recognized text regions.
+ * @param index The index built from the detections.
+ * @param targets The target texts to match.
+ * @param thread_pool The workers running the queries, or nullptr to run them on the calling thread.
+ * @return The result of every target, in the order of the targets.
+ */
+auto MatchTargets(const std::vector<DetectReadResult> &detections, const TextIndex &index,
+                  const std::vector<std::string_view> &targets, ThreadPool *thread_pool = nullptr) noexcept
+    -> std::vector<MatchResult>;
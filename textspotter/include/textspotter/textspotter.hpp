@@ -1,11 +1,28 @@
 #pragma once
 
+#include <cstddef>
 #include <memory>
+#include <mutex>
 #include <opencv2/core.hpp>
 #include <optional>
 #include <string>
+#include <string_view>
+#include <vector>
 
+#include "textspotter/detect_read.hpp"
+#include "textspotter/lazy_recognition.hpp"
 #include "textspotter/result_type.hpp"
+#include "textspotter/text_index.hpp"
+#include "textspotter/threading.hpp"
+
+class EastTextDetector;
+class LazyPreprocessor;
+class Metrics;
+class OcrCache;
+class PreprocessPipeline;
+struct RecognitionProfile;
+class TesseractPool;
+class ThreadPool;
 
 /**
  * @brief The TextSpotter class is designed for text detection and recognition in images.
@@ -19,13 +36,163 @@ class TextSpotter {
    *
    * @param model_path The file path to the frozen EAST text detection model (default: "frozen_east_text_detection.pb").
    * @param enable_multi_thread Whether to enable multi-threading for detection (default: true).
+   * @param num_ocr_workers Number of recognition worker threads and of Tesseract engines kept alive, 0 means one per
+   * hardware thread (default: 0). Engines are initialized lazily and reused across images.
    */
-  explicit TextSpotter(std::string_view model_path = "frozen_east_text_detection.pb", bool enable_multi_thread = true);
+  explicit TextSpotter(std::string_view model_path = "frozen_east_text_detection.pb", bool enable_multi_thread = true,
+                       std::size_t num_ocr_workers = 0);
 
   /**
    * @brief Destroys the TextSpotter object.
    */
-  ~TextSpotter() = default;
+  ~TextSpotter();
+
+  /**
+   * @brief Loads the EAST model and prepares it, together with the OCR engines, for the first image.
+   *
+   * @details The detector is kept resident for the lifetime of the TextSpotter. Without an explicit call, the model is
+   * loaded by the first DetectRead() and the first image pays the loading and graph allocation cost.
+   *
+   * @throws cv::Exception if the model cannot be loaded, std::runtime_error if Tesseract cannot be initialized.
+   */
+  auto Warmup() -> void;
+
+  /**
+   * @brief Replaces the EAST detector, e.g. by one wrapping a network built or loaded from memory.
+   *
+   * @details The model path given to the constructor is not used anymore, unless nullptr is set, in which case the
+   * model is loaded from it again on next use.
+   *
+   * @param detector The detector to use.
+   */
+  auto SetDetector(std::unique_ptr<EastTextDetector> detector) noexcept -> void;
+
+  /**
+   * @brief Sets the tuning options used by the following DetectRead() calls.
+   *
+   * @param options Tuning options of the detect and read pipeline.
+   */
+  auto SetDetectReadOptions(const DetectReadOptions &options) noexcept -> void;
+
+  /**
+   * @brief Sets the pipeline preparing the images for recognition, replacing the default profile.
+   *
+   * @details Takes precedence over DetectReadOptions::preprocess_pipeline_. Use PreprocessPipeline::Fast() to trade
+   * some accuracy on noisy images for a much shorter preprocessing.
+   *
+   * @param pipeline The preprocessing pipeline.
+   */
+  auto SetPreprocessPipeline(PreprocessPipeline pipeline) -> void;
+
+  /**
+   * @brief Gets the pipeline preparing the images for recognition, e.g. to query its stage timings.
+   */
+  auto GetPreprocessPipeline() const noexcept -> const PreprocessPipeline &;
+
+  /**
+   * @brief Sets how the detected regions are recognized, replacing the default profile.
+   *
+   * @details Use RecognitionProfile::SingleLine() to skip the layout analysis Tesseract otherwise runs on every
+   * region. The engines already initialized are dropped, the next ones are initialized with the profile on first use
+   * or by Warmup(). Regions cached by the OcrCache under another profile are not reused.
+   *
+   * @param profile The recognition profile.
+   */
+  auto SetRecognitionProfile(const RecognitionProfile &profile) -> void;
+
+  /**
+   * @brief Gets how the detected regions are recognized.
+   */
+  auto GetRecognitionProfile() const noexcept -> const RecognitionProfile &;
+
+  /**
+   * @brief Shares the cores between OpenCV, the recognition workers and Tesseract, see ThreadingConfig.
+   *
+   * @details Applies the process-wide settings with ApplyThreadingConfig, then replaces the recognition workers and
+   * the Tesseract engines with ocr_threads_ of each, pinned to their cores if enabled. Without multi-threading, the
+   * OpenMP recognition loop gets ocr_threads_ threads unless DetectReadOptions::omp_num_threads_ is set. Call it before
+   * Warmup(), the engines already initialized are dropped.
+   *
+   * @param config The threading configuration.
+   */
+  auto SetThreadingConfig(const ThreadingConfig &config) -> void;
+
+  /**
+   * @brief Gets the resolved threading configuration, std::nullopt if none was set.
+   */
+  auto GetThreadingConfig() const noexcept -> const std::optional<ThreadingConfig> &;
+
+  /**
+   * @brief Enables a cache of recognized regions, so that regions already seen are not recognized again.
+   *
+   * @details Replaces the previous cache, if any. The returned cache can be saved to and loaded from a file to keep
+   * the results between runs, and reports its hit and miss counts.
+   *
+   * @param capacity_bytes Approximate memory budget of the cache (default: 16 MiB).
+   * @return The cache.
+   */
+  auto EnableOcrCache(std::size_t capacity_bytes = 16 * 1024 * 1024) -> OcrCache &;
+
+  /**
+   * @brief Disables and drops the cache of recognized regions.
+   */
+  auto DisableOcrCache() noexcept -> void;
+
+  /**
+   * @brief Gets the cache of recognized regions.
+   *
+   * @return The cache, or nullptr if it is disabled.
+   */
+  auto GetOcrCache() const noexcept -> OcrCache *;
+
+  /**
+   * @brief Enables the metrics of the pipeline: time spent in every stage and counts of boxes, words and cache hits.
+   *
+   * @details Replaces the previous metrics, if any. The stages are named by the kStage constants and the counters by
+   * the kCounter constants of metrics.hpp. The metrics can be exported as JSON or in the Prometheus text format.
+   *
+   * @return The metrics.
+   */
+  auto EnableMetrics() -> Metrics &;
+
+  /**
+   * @brief Disables and drops the metrics.
+   */
+  auto DisableMetrics() noexcept -> void;
+
+  /**
+   * @brief Gets the metrics of the pipeline.
+   *
+   * @return The metrics, or nullptr if they are disabled.
+   */
+  auto GetMetrics() const noexcept -> Metrics *;
+
+  /**
+   * @brief Enables or disables the incremental mode, meant for consecutive frames of a video.
+   *
+   * @details In incremental mode, DetectRead() compares the loaded image with the image of the previous call and only
+   * detects and reads the regions that changed, results outside of these regions are reused. When nothing changed,
+   * the previous results are returned as is. When more than half of the image changed, the whole image is processed.
+   *
+   * @param enable Whether the incremental mode is enabled.
+   * @param block_size Width and height in pixels of the blocks compared between frames (default: 32).
+   * @param threshold Mean absolute pixel difference above which a block is changed (default: 4.0).
+   */
+  auto SetIncremental(bool enable, int block_size = 32, double threshold = 4.0) noexcept -> void;
+
+  /**
+   * @brief Enables or disables the lazy recognition, meant for images queried for a few targets only.
+   *
+   * @details In lazy mode, DetectRead() only detects the text regions and MatchText() recognizes them on demand. The
+   * regions most likely to hold the target come first: those whose width fits the length of the target, then those
+   * close to the previous match. The search stops at the first match scoring at least min_score, so a closer match in
+   * a region not read yet may be missed. Recognized regions are kept for the next queries on the same image.
+   * MatchTexts() recognizes every region. The incremental mode is not used in lazy mode.
+   *
+   * @param enable Whether the lazy recognition is enabled.
+   * @param min_score Smallest MatchResult::score_ ending the search (default: 0.8).
+   */
+  auto SetLazyRecognition(bool enable, float min_score = 0.8F) noexcept -> void;
 
   /**
    * @brief Loads an image from the specified file path.
@@ -37,35 +204,139 @@ class TextSpotter {
   /**
    * @brief Loads an image from a provided OpenCV Mat object.
    *
+   * @details The pixels are copied, so the caller may modify or release the image afterwards. Use LoadImageView() to
+   * skip the copy.
+   *
    * @param image An OpenCV Mat representing the image.
    */
   auto LoadImage(const cv::Mat &image) noexcept -> void;
 
+  /**
+   * @brief Loads an image without copying its pixels.
+   *
+   * @details The TextSpotter shares the pixels of the image, or of the region of it the header covers. The caller must
+   * not modify them until the next image is loaded. BGR, BGRA and grayscale images are accepted, the detector converts
+   * the last two to BGR on its own copy.
+   *
+   * @param image An OpenCV Mat representing the image, or a region of a larger image.
+   */
+  auto LoadImageView(const cv::Mat &image) noexcept -> void;
+
+  /**
+   * @brief Loads an image from an external buffer without copying its pixels.
+   *
+   * @details Rows may be padded, e.g. for a frame of a capture device or of another library. The buffer is not owned:
+   * it must stay valid and unmodified until the next image is loaded.
+   *
+   * @param data Pointer to the first pixel.
+   * @param width Width of the image in pixels.
+   * @param height Height of the image in pixels.
+   * @param type OpenCV type of the pixels, CV_8UC3 for BGR, CV_8UC4 for BGRA or CV_8UC1 for grayscale.
+   * @param step Number of bytes between the starts of two rows, 0 for rows without padding (default: 0).
+   */
+  auto LoadImageView(const void *data, int width, int height, int type, std::size_t step = 0) noexcept -> void;
+
   /**
    * @brief Gets the loaded image.
    *
-   * @return The loaded image as an OpenCV Mat.
+   * @details The pixels are not copied, clone the image to modify it.
+   *
+   * @return The loaded image as an OpenCV Mat, empty if no image is loaded.
    */
-  auto GetImage() const noexcept -> cv::Mat;
+  auto GetImage() const noexcept -> const cv::Mat &;
 
   /**
    * @brief Detects and reads text in the loaded image.
    *
-   * @return A vector of DetectReadResult objects representing detected and recognized text regions.
+   * @details In lazy mode, only detects the text regions, the returned results then grow as MatchText() recognizes
+   * them.
+   *
+   * @return The detected and recognized text regions, valid until the next call.
    */
-  auto DetectRead() noexcept -> std::vector<DetectReadResult>;
+  auto DetectRead() noexcept -> const std::vector<DetectReadResult> &;
 
   /**
    * @brief Matches a target text in the loaded image and returns its position.
    *
+   * @details The words read by the last DetectRead() are indexed, so a query does not scan every detection.
+   *
    * @param target The target text to match.
    * @return The position of the matched text as a cv::Point.
    */
   auto MatchText(std::string_view target) const noexcept -> cv::Point;
 
+  /**
+   * @brief Matches many target texts in the loaded image at once.
+   *
+   * @details Cheaper than one MatchText() call per target: a word shared by several targets is looked up once, and
+   * the queries run on the recognition workers when multi-threading is enabled.
+   *
+   * @param targets The target texts to match.
+   * @return The position of every target, {-1, -1} if not found, and how closely the matched text reads like it.
+   */
+  auto MatchTexts(const std::vector<std::string_view> &targets) const noexcept -> std::vector<MatchResult>;
+
  private:
-  bool enable_multi_thread_;                   // Whether multi-threading is enabled for detection.
-  std::string model_path_;                     // The file path to the EAST model.
-  std::unique_ptr<cv::Mat> image_;             // The loaded image.
-  std::vector<DetectReadResult> det_results_;  // Detected and recognized text results.
+  /**
+   * @brief Loads the EAST detector if it is not loaded yet.
+   */
+  auto LoadDetector() -> void;
+
+  /**
+   * @brief Replaces the Tesseract engines with a pool of another size or profile, in the same language.
+   */
+  auto RebuildOcrPool(std::size_t size, const RecognitionProfile &profile) -> void;
+
+  /**
+   * @brief Detects and reads text in an image or a region of it, with the configured threading and options.
+   */
+  auto DetectReadImage(const cv::Mat &image) noexcept -> std::vector<DetectReadResult>;
+
+  /**
+   * @brief Detects and reads only the regions of the loaded image that changed since the previous call.
+   *
+   * @return False if the changes are too large, then the whole image must be processed instead.
+   */
+  auto DetectReadChanged() noexcept -> bool;
+
+  /**
+   * @brief Gets the options of the pipeline, with the preprocessing, cache and metrics of the TextSpotter.
+   */
+  auto GetPipelineOptions() const noexcept -> DetectReadOptions;
+
+  /**
+   * @brief Forgets the regions of the lazy recognition and their preprocessed tiles.
+   */
+  auto ResetLazyState() noexcept -> void;
+
+  /**
+   * @brief Recognizes regions of the loaded image for the lazy recognition, sharing the preprocessed tiles between
+   * the calls.
+   */
+  auto ReadLazyRegions(const std::vector<TextDetectionResult> &regions) const noexcept
+      -> std::vector<DetectReadResult>;
+
+  bool enable_multi_thread_;                                 // Whether multi-threading is enabled for detection.
+  std::string model_path_;                                   // The file path to the EAST model.
+  cv::Mat image_;                                            // The loaded image, possibly borrowed.
+  bool image_borrowed_;                                      // Whether image_ shares pixels owned by the caller.
+  std::vector<DetectReadResult> det_results_;                // Detected and recognized text results.
+  TextIndex text_index_;                                     // Fuzzy index of the words of det_results_.
+  std::unique_ptr<TesseractPool> ocr_pool_;                  // Tesseract engines reused across images.
+  std::unique_ptr<EastTextDetector> detector_;               // Resident EAST detector, loaded on first use.
+  std::unique_ptr<ThreadPool> thread_pool_;                  // Workers running the recognition tasks.
+  DetectReadOptions options_;                                // Tuning options of the detect and read pipeline.
+  std::unique_ptr<PreprocessPipeline> preprocess_pipeline_;  // Pipeline preparing the images for recognition.
+  bool incremental_;                                         // Whether only changed regions are processed.
+  int block_size_;                                           // Size of the blocks compared between frames.
+  double change_threshold_;                                  // Mean difference above which a block changed.
+  cv::Mat previous_image_;                                   // Image of the previous DetectRead() call.
+  std::unique_ptr<OcrCache> ocr_cache_;                      // Cache of recognized regions, may be null.
+  std::unique_ptr<Metrics> metrics_;                         // Stage timings and counts, may be null.
+  bool lazy_;                                                // Whether regions are recognized on demand.
+  float lazy_min_score_;                                     // Match score ending a lazy search.
+  mutable LazyRecognizer lazy_recognizer_;                   // Regions detected in lazy mode and their words.
+  mutable std::unique_ptr<LazyPreprocessor> lazy_tiles_;     // Tiles preprocessed for the lazy recognition.
+  mutable std::mutex lazy_mutex_;                            // Guards the recognition on demand.
+  std::optional<ThreadingConfig> threading_;                 // Sharing of the cores, if set.
 };
@@ -0,0 +1,226 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <opencv2/core.hpp>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "textspotter/bounded_queue.hpp"
+#include "textspotter/detect_read.hpp"
+#include "textspotter/result_type.hpp"
+
+class EastTextDetector;
+class TesseractPool;
+class ThreadPool;
+
+/**
+ * @struct StreamStageStats
+ * @brief Latency statistics of one stage of a TextSpotterStream.
+ */
+struct StreamStageStats {
+  std::string name_;            // Name of the stage.
+  std::size_t frames_ = 0;      // Number of frames processed by the stage.
+  std::size_t dropped_ = 0;     // Number of frames dropped because the next stage was busy.
+  double total_seconds_ = 0.0;  // Total processing time of the frames.
+  double max_seconds_ = 0.0;    // Longest processing time of a frame.
+};
+
+/**
+ * @struct StreamFrameResult
+ * @brief The text read in a frame of a stream, and where the targets are.
+ */
+struct StreamFrameResult {
+  std::size_t frame_index_;                   // Position of the frame in the source, dropped frames included.
+  std::vector<DetectReadResult> detections_;  // Detected and recognized text of the frame.
+  std::vector<MatchResult> matches_;          // Result of every target, in the order of the targets.
+  double latency_seconds_;                    // Time from the capture of the frame to its result.
+};
+
+/**
+ * @class TextSpotterStream
+ * @brief Detects, reads and matches text in a continuous stream of frames, e.g. a camera.
+ *
+ * @details Capture, EAST detection, recognition and matching run as four pipeline stages on their own threads, linked
+ * by bounded queues, so the detection of a frame overlaps the recognition of the previous one. The regions of a frame
+ * are recognized on a pool of worker threads. When a stage falls behind, the oldest frame waiting for it is dropped,
+ * which keeps the latency of a live stream bounded; a stream created without frame dropping applies backpressure
+ * instead, so that every frame of a file is processed.
+ */
+class TextSpotterStream {
+ public:
+  /**
+   * @brief Produces the next frame, returns false at the end of the stream.
+   */
+  using FrameSource = std::function<bool(cv::Mat &frame)>;
+
+  /**
+   * @brief Receives the result of every processed frame, on the thread of the matching stage.
+   */
+  using ResultCallback = std::function<void(const StreamFrameResult &result)>;
+
+  /**
+   * @brief Finds the text regions of a frame, on the thread of the detect stage.
+   */
+  using DetectStage = std::function<std::vector<TextDetectionResult>(const cv::Mat &frame)>;
+
+  /**
+   * @brief Reads the text of the regions found in a frame, on the thread of the read stage.
+   */
+  using ReadStage = std::function<std::vector<DetectReadResult>(const cv::Mat &frame,
+                                                                const std::vector<TextDetectionResult> &regions)>;
+
+  /**
+   * @brief Constructs a stream, the model is loaded by Start().
+   *
+   * @param model_path The file path to the frozen EAST text detection model (default: "frozen_east_text_detection.pb").
+   * @param num_ocr_workers Number of recognition worker threads and of Tesseract engines, 0 means one per hardware
+   * thread (default: 0).
+   * @param queue_capacity Number of frames waiting between two stages (default: 2).
+   * @param drop_frames Whether frames are dropped when a stage falls behind, rather than blocking the previous stage
+   * (default: true).
+   */
+  explicit TextSpotterStream(std::string_view model_path = "frozen_east_text_detection.pb",
+                             std::size_t num_ocr_workers = 0, std::size_t queue_capacity = 2, bool drop_frames = true);
+
+  /**
+   * @brief Stops the stream and destroys it.
+   */
+  ~TextSpotterStream();
+
+  TextSpotterStream(const TextSpotterStream &) = delete;
+  auto operator=(const TextSpotterStream &) -> TextSpotterStream & = delete;
+
+  /**
+   * @brief Sets the tuning options of the recognition, used from the next Start().
+   */
+  auto SetDetectReadOptions(const DetectReadOptions &options) -> void;
+
+  /**
+   * @brief Sets the texts matched in every frame, used from the next Start().
+   */
+  auto SetTargets(std::vector<std::string> targets) -> void;
+
+  /**
+   * @brief Replaces the EAST detection of the detect stage, used from the next Start().
+   *
+   * @param detect The detection, nullptr restores the EAST detector.
+   */
+  auto SetDetectStage(DetectStage detect) -> void;
+
+  /**
+   * @brief Replaces the Tesseract recognition of the read stage, used from the next Start().
+   *
+   * @param read The recognition, nullptr restores Tesseract.
+   */
+  auto SetReadStage(ReadStage read) -> void;
+
+  /**
+   * @brief Starts processing the frames of the source, stopping the previous run if any.
+   *
+   * @details The options, the targets and the stages are copied, setting them while the stream runs only affects the
+   * next run.
+   *
+   * @param source The source of the frames, called on the capture thread.
+   * @param callback The receiver of the results, called on the matching thread in frame order.
+   * @throws cv::Exception if the model cannot be loaded, std::runtime_error if Tesseract cannot be initialized. Neither
+   * is loaded when its stage is replaced.
+   */
+  auto Start(FrameSource source, ResultCallback callback) -> void;
+
+  /**
+   * @brief Waits until the source is exhausted and every frame left went through the pipeline.
+   *
+   * @details Must not be called from the callback.
+   */
+  auto Wait() -> void;
+
+  /**
+   * @brief Stops capturing and discards the frames in flight. Must not be called from the callback.
+   */
+  auto Stop() -> void;
+
+  /**
+   * @brief Gets the latency statistics of the capture, detect, read and match stages, and end to end.
+   */
+  auto GetStageStats() const -> std::vector<StreamStageStats>;
+
+  /**
+   * @brief Opens a video file or a camera.
+   *
+   * @param source The path of a video file, or the number of a camera device.
+   * @return The source of the frames of the video.
+   * @throws std::runtime_error if the video cannot be opened.
+   */
+  static auto OpenVideo(std::string_view source) -> FrameSource;
+
+  /**
+   * @brief Generates frames with moving lines of text, to test a stream without a camera or a video file.
+   *
+   * @param num_frames Number of frames before the end of the stream.
+   * @param size Size of the frames (default: 1280x720).
+   * @return The source of the frames.
+   */
+  static auto SyntheticVideo(int num_frames, cv::Size size = {1280, 720}) -> FrameSource;
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  /**
+   * @struct Frame
+   * @brief A frame travelling through the stages, with what the previous stages found in it.
+   */
+  struct Frame {
+    std::size_t index_;                            // Position of the frame in the source.
+    Clock::time_point captured_;                   // Time of capture.
+    cv::Mat image_;                                // The frame.
+    std::vector<TextDetectionResult> detections_;  // Regions found by the detect stage.
+    std::vector<DetectReadResult> results_;        // Text found by the read stage.
+  };
+
+  /**
+   * @brief Positions of the stages in the statistics.
+   */
+  enum Stage : std::size_t { kCapture, kDetect, kRead, kMatch, kEndToEnd, kNumStages };
+
+  auto CaptureLoop(FrameSource source) -> void;
+  auto DetectLoop(DetectStage detect) -> void;
+  auto ReadLoop(ReadStage read) -> void;
+  auto MatchLoop(ResultCallback callback, std::vector<std::string> targets) -> void;
+
+  /**
+   * @brief Hands a frame to the next stage, dropping the oldest waiting frame if needed and enabled.
+   */
+  auto Forward(BoundedQueue<Frame> &queue, Frame frame, Stage stage) -> void;
+
+  /**
+   * @brief Adds the processing time of a frame to the statistics of a stage.
+   */
+  auto Record(Stage stage, Clock::time_point start) -> void;
+
+  auto Join() -> void;
+
+  std::string model_path_;                             // The file path to the EAST model.
+  std::size_t queue_capacity_;                         // Number of frames waiting between two stages.
+  bool drop_frames_;                                   // Whether frames are dropped when a stage falls behind.
+  DetectReadOptions options_;                          // Tuning options of the recognition.
+  std::vector<std::string> targets_;                   // Texts matched in every frame.
+  DetectStage detect_;                                 // Detection replacing EAST, may be empty.
+  ReadStage read_;                                     // Recognition replacing Tesseract, may be empty.
+  std::unique_ptr<TesseractPool> ocr_pool_;            // Tesseract engines of the read stage.
+  std::unique_ptr<ThreadPool> thread_pool_;            // Workers of the read and match stages.
+  std::unique_ptr<EastTextDetector> detector_;         // Resident EAST detector, loaded on first start.
+  std::unique_ptr<BoundedQueue<Frame>> detect_queue_;  // Frames waiting for the detect stage.
+  std::unique_ptr<BoundedQueue<Frame>> read_queue_;    // Frames waiting for the read stage.
+  std::unique_ptr<BoundedQueue<Frame>> match_queue_;   // Frames waiting for the match stage.
+  std::vector<std::thread> threads_;                   // Threads of the stages.
+  std::atomic<bool> stop_;                             // Whether the capture must stop.
+  std::vector<StreamStageStats> stats_;                // Statistics of every stage.
+  mutable std::mutex stats_mutex_;                     // Protects the statistics.
+};
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @class ThreadPool
+ * @brief A fixed size, work-stealing thread pool.
+ *
+ * @details Every worker owns a task deque. Tasks submitted from outside the pool are distributed round-robin over the
+ * deques, tasks submitted from a worker go to the deque of that worker. A worker pops from the back of its own deque
+ * and, once it runs out of work, steals from the front of the other deques. The workers are started once and reused,
+ * so submitting a task never creates a thread.
+ *
+ * @note A task must not block on the result of another task of the same pool, that task may be queued behind it.
+ */
+class ThreadPool {
+ public:
+  /**
+   * @brief Starts the workers.
+   *
+   * @param num_workers Number of worker threads, 0 means std::thread::hardware_concurrency().
+   * @param cores Cores the workers are pinned to, worker i runs on cores[i % cores.size()]. Empty leaves the workers
+   * to the scheduler (default). Pinning is only supported on Linux, a core the process may not run on is ignored.
+   * @param engine_threads Number of OpenMP threads a task may start, set on every worker with LimitEngineThreads(). 0
+   * leaves the OpenMP default (default).
+   */
+  explicit ThreadPool(std::size_t num_workers = 0, std::vector<int> cores = {}, std::size_t engine_threads = 0);
+
+  ThreadPool(const ThreadPool &) = delete;
+  auto operator=(const ThreadPool &) -> ThreadPool & = delete;
+
+  /**
+   * @brief Runs the tasks still queued, then joins the workers.
+   */
+  ~ThreadPool();
+
+  /**
+   * @brief Submits a task to the pool.
+   *
+   * @param task A callable taking no argument.
+   * @return A future holding the result of the task, or the exception it threw.
+   */
+  template <typename F>
+  auto Submit(F &&task) -> std::future<std::invoke_result_t<std::decay_t<F>>> {
+    using R = std::invoke_result_t<std::decay_t<F>>;
+    auto packaged = std::make_shared<std::packaged_task<R()>>(std::forward<F>(task));
+    auto future = packaged->get_future();
+    Push([packaged]() { (*packaged)(); });
+    return future;
+  }
+
+  /**
+   * @brief Gets the number of worker threads.
+   */
+  auto Size() const noexcept -> std::size_t { return workers_.size(); }
+
+  /**
+   * @brief Gets the index of the calling worker thread in this pool.
+   *
+   * @return The worker index, or std::nullopt if the calling thread is not a worker of this pool.
+   */
+  auto CurrentWorkerIndex() const noexcept -> std::optional<std::size_t>;
+
+  /**
+   * @brief Gets the process-wide pool shared by the free detect and read functions.
+   */
+  static auto Global() -> ThreadPool &;
+
+ private:
+  /**
+   * @struct Worker
+   * @brief The task deque owned by a worker thread.
+   */
+  struct Worker {
+    std::deque<std::function<void()>> tasks_;
+    std::mutex mutex_;
+  };
+
+  auto Push(std::function<void()> task) -> void;
+  auto TryPop(std::size_t index, std::function<void()> &task) -> bool;
+  auto TrySteal(std::size_t index, std::function<void()> &task) -> bool;
+  auto Run(std::size_t index) -> void;
+
+  std::vector<std::unique_ptr<Worker>> workers_;  // Task deques, one per worker.
+  std::vector<int> cores_;                        // Cores the workers are pinned to, may be empty.
+  std::size_t engine_threads_;                    // OpenMP threads of a worker, 0 for the OpenMP default.
+  std::vector<std::thread> threads_;              // Worker threads.
+  std::mutex mutex_;                              // Guards pending_ and stop_.
+  std::condition_variable cv_;                    // Signals new tasks or shutdown to idle workers.
+  std::size_t pending_;                           // Number of queued tasks.
+  std::size_t next_;                              // Next deque for tasks submitted from outside.
+  bool stop_;                                     // Whether the pool is shutting down.
+};
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * @struct ThreadingConfig
+ * @brief How the cores of the process are shared between OpenCV, the recognition workers and Tesseract.
+ *
+ * @details Three kinds of threads compete for the cores: the pool of OpenCV, running the forward pass of the EAST
+ * network and the preprocessing filters, the recognition workers of the library, and the OpenMP threads of Tesseract
+ * itself. Left alone, each sizes itself to the whole machine. The configuration splits a budget of cores between the
+ * first two and limits the third, see ApplyThreadingConfig and LimitEngineThreads.
+ */
+struct ThreadingConfig {
+  /**
+   * @brief Number of cores the library may use, 0 means std::thread::hardware_concurrency().
+   */
+  std::size_t total_threads_ = 0;
+
+  /**
+   * @brief Number of threads of the OpenCV pool, 0 means a quarter of the budget.
+   *
+   * @details The pool is process-wide and serves both the detection and the preprocessing, which run one after the
+   * other.
+   */
+  std::size_t opencv_threads_ = 0;
+
+  /**
+   * @brief Number of recognition workers and of Tesseract engines, 0 means the rest of the budget.
+   */
+  std::size_t ocr_threads_ = 0;
+
+  /**
+   * @brief Number of threads every Tesseract engine may start for its own OpenMP loops.
+   *
+   * @details The recognition workers already recognize several regions at once, so 1 avoids starting a team of
+   * threads per engine. See LimitEngineThreads for when the limit applies.
+   */
+  std::size_t ocr_engine_threads_ = 1;
+
+  /**
+   * @brief Whether the recognition workers are pinned to cores, on Linux only.
+   *
+   * @details Worker i runs on core first_core_ + opencv_threads_ + i, leaving the first cores of the budget to
+   * OpenCV. Pin only when the process has the cores to itself.
+   */
+  bool pin_threads_ = false;
+
+  /**
+   * @brief First core of the budget when pinning threads.
+   */
+  int first_core_ = 0;
+
+  /**
+   * @brief Gets the configuration with every automatic value resolved.
+   *
+   * @details Every share gets at least one thread, so a budget smaller than two threads is exceeded.
+   *
+   * @return The configuration, with total_threads_, opencv_threads_ and ocr_threads_ set.
+   */
+  auto Resolve() const noexcept -> ThreadingConfig;
+
+  /**
+   * @brief Gets the cores the recognition workers are pinned to.
+   *
+   * @return One core per worker, empty if pin_threads_ is not set.
+   */
+  auto GetOcrCores() const -> std::vector<int>;
+};
+
+/**
+ * @function ApplyThreadingConfig
+ * @brief Applies the process-wide part of a threading configuration.
+ *
+ * @details Sets the number of threads of the OpenCV pool with cv::setNumThreads. When the library is built with
+ * enable_omp, the recognition loop is itself an OpenMP loop and the loops of Tesseract nested in it are kept on the
+ * calling thread.
+ *
+ * The sizes of the recognition workers are not process-wide, see TextSpotter::SetThreadingConfig, and neither is the
+ * number of threads of the engines, see LimitEngineThreads.
+ *
+ * @param config The configuration, resolved if needed.
+ */
+auto ApplyThreadingConfig(const ThreadingConfig &config) -> void;
+
+/**
+ * @function LimitEngineThreads
+ * @brief Limits the OpenMP threads the loops of a Tesseract engine start when run on the calling thread.
+ *
+ * @details The limit is an OpenMP setting of the calling thread, the recognition workers of a ThreadPool set it when
+ * they start. It is only effective when the library is built with enable_omp and so shares the OpenMP runtime of
+ * Tesseract. Otherwise set OMP_THREAD_LIMIT in the environment before starting the process, an OpenMP runtime reads it
+ * once, when it is loaded.
+ *
+ * @param num_threads Number of threads, at least 1, usually ThreadingConfig::ocr_engine_threads_.
+ */
+auto LimitEngineThreads(std::size_t num_threads) noexcept -> void;
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <vector>
+
+/**
+ * @function TileOrigins
+ * @brief Computes the origins of the tiles covering a length, used by EastTextDetector::detectTiled().
+ *
+ * @details Tiles start every tile - overlap pixels, the last tile is aligned with the end so that no tile leaves the
+ * image. A length not larger than a tile is covered by a single tile at 0.
+ *
+ * @param length The length to cover, in pixels.
+ * @param tile The length of a tile.
+ * @param overlap Number of pixels shared by neighbouring tiles.
+ * @return The origins, in increasing order.
+ */
+auto TileOrigins(int length, int tile, int overlap) -> std::vector<int>;
+
+/**
+ * @function IsHeldByNeighbour
+ * @brief Checks whether a box found in a tile is dropped in favour of the neighbouring tile.
+ *
+ * @details A box cut by an inner border of the tile is dropped when it lies within the band shared with the
+ * neighbour, which then sees it whole. A box starting within a few pixels of the far side of the band is kept: the
+ * neighbour may see it cut by its own border, and one of the two copies must survive. Both copies of a box kept by
+ * two tiles are merged by the non-maximum suppression.
+ *
+ * @param box The bounding box, in tile coordinates.
+ * @param tile The tile, in image coordinates.
+ * @param image_size The size of the image.
+ * @param overlap Number of pixels shared by neighbouring tiles.
+ * @return True if the box must be dropped.
+ */
+auto IsHeldByNeighbour(const cv::Rect &box, const cv::Rect &tile, const cv::Size &image_size, int overlap) -> bool;
@@ -2,9 +2,13 @@
 
 #include <fmt/core.h>
 
+#include <array>
 #include <chrono>
+#include <cstdint>
 #include <opencv2/core/core.hpp>
+#include <optional>
 #include <string>
+#include <vector>
 
 /**
  * @class ScopedTimer
@@ -61,9 +65,9 @@ class Timer {
 
   /**
    * @brief Gets the elapsed time in seconds between the start and end of the timer.
-   * @return Elapsed time in seconds.
+   * @return Elapsed time in seconds, with sub-second precision.
    */
-  auto GetElapsedSeconds() const noexcept -> int;
+  auto GetElapsedSeconds() const noexcept -> double;
 
  private:
   std::chrono::high_resolution_clock::time_point start_;
@@ -74,14 +78,15 @@ class Timer {
  * @function LoadImage
  * @brief Loads an image from a given file path.
  * @param image_path Path to the image file.
+ * @param size Size the image is resized to, an empty size keeps the native resolution (default: 1280x720).
  * @return Loaded image as cv::Mat.
  */
-auto LoadImage(const char *image_path) -> cv::Mat;
+auto LoadImage(const char *image_path, const cv::Size &size = cv::Size(1280, 720)) -> cv::Mat;
 
 /**
- * @overload auto LoadImage(std::string_view image_path) -> cv::Mat
+ * @overload auto LoadImage(std::string_view image_path, const cv::Size &size) -> cv::Mat
  */
-auto LoadImage(std::string_view image_path) -> cv::Mat;
+auto LoadImage(std::string_view image_path, const cv::Size &size = cv::Size(1280, 720)) -> cv::Mat;
 
 /**
  * @function Preprocess
@@ -91,6 +96,75 @@ auto LoadImage(std::string_view image_path) -> cv::Mat;
  */
 auto Preprocess(const cv::Mat &image) noexcept -> cv::Mat;
 
+/**
+ * @function RectifyRegion
+ * @brief Warps a rotated region of an image into a tight upright crop.
+ *
+ * @details The region is enlarged by the padding on every side, then rotated so that its width runs horizontally.
+ * Recognizing the crop instead of the axis-aligned bounding box of a slanted region hands fewer pixels to the OCR
+ * engine and keeps the text lines horizontal.
+ *
+ * @param image The image containing the region.
+ * @param box The rotated region, in image coordinates.
+ * @param padding Number of pixels added on every side of the region.
+ * @param crop_to_image Output 2x3 affine transform mapping crop coordinates back to image coordinates.
+ * @return The upright crop, or an empty cv::Mat if the region is empty.
+ */
+auto RectifyRegion(const cv::Mat &image, const cv::RotatedRect &box, int padding, cv::Mat &crop_to_image) noexcept
+    -> cv::Mat;
+
+/**
+ * @function MapCropToImage
+ * @brief Maps a box of a crop made by RectifyRegion back to an axis-aligned box in image coordinates.
+ * @param box The box, in crop coordinates.
+ * @param crop_to_image The transform given by RectifyRegion.
+ * @param image_size Size of the image, the box is clipped to it.
+ * @return The smallest box containing the mapped box, in image coordinates.
+ */
+auto MapCropToImage(const cv::Rect &box, const cv::Mat &crop_to_image, const cv::Size &image_size) noexcept
+    -> cv::Rect;
+
+/**
+ * @function FoldAngle
+ * @brief Folds the angle of a rotated box into [-90, 90] degrees, the same box read the other way round.
+ * @param angle The angle in degrees.
+ * @return The folded angle in degrees, upside down text is not told apart.
+ */
+auto FoldAngle(float angle) noexcept -> float;
+
+/**
+ * @function FindChangedRegions
+ * @brief Finds the regions that differ between two frames of a video.
+ *
+ * @details The frames are compared block by block, a block is changed when the mean absolute difference of its pixels
+ * exceeds the threshold. Neighbouring changed blocks are grouped into one region.
+ *
+ * @param previous The previous frame.
+ * @param current The current frame.
+ * @param block_size Width and height of a block in pixels.
+ * @param threshold Mean absolute difference above which a block is changed.
+ * @return The changed regions, in current frame coordinates. The whole frame if the frames differ in size or type.
+ */
+auto FindChangedRegions(const cv::Mat &previous, const cv::Mat &current, int block_size = 32,
+                        double threshold = 4.0) noexcept -> std::vector<cv::Rect>;
+
+/**
+ * @function GrowChangedRegions
+ * @brief Grows the changed regions of a frame into the regions to read again.
+ *
+ * @details Every region is grown by the margin, so that text on its border is read in full. The regions are then grown
+ * by the boxes of the previous results they touch and merged when they overlap, until neither changes anything: every
+ * box ends either inside a region or clear of all of them, and no pixel is read twice.
+ *
+ * @param regions The changed regions, see FindChangedRegions.
+ * @param boxes The boxes of the previous results.
+ * @param margin Number of pixels added on every side of a region.
+ * @param bounds The frame, the regions are clipped to it.
+ * @return The regions to read again, not overlapping each other.
+ */
+auto GrowChangedRegions(std::vector<cv::Rect> regions, const std::vector<cv::Rect> &boxes, int margin,
+                        const cv::Rect &bounds) noexcept -> std::vector<cv::Rect>;
+
 /**
  * @function CalcLevenshteinDistance
  * @brief Calculates the Levenshtein distance between two strings.
@@ -100,6 +174,58 @@ auto Preprocess(const cv::Mat &image) noexcept -> cv::Mat;
  */
 auto CalcLevenshteinDistance(std::string_view s1, std::string_view s2) noexcept -> int;
 
+/**
+ * @function CalcLevenshteinDistance
+ * @brief Calculates the Levenshtein distance between two strings, giving up once it exceeds a budget.
+ *
+ * @details No memory is allocated when the shorter string has at most 64 characters, which is compared with a
+ * bit-parallel kernel. Longer strings are compared within the diagonal band allowed by the budget.
+ *
+ * @param s1 The first string.
+ * @param s2 The second string.
+ * @param max_distance The largest distance of interest, negative values are treated as 0.
+ * @param case_sensitive Whether letters differing only in case are different characters.
+ * @return The Levenshtein distance if it is at most max_distance, max_distance + 1 otherwise.
+ */
+auto CalcLevenshteinDistance(std::string_view s1, std::string_view s2, int max_distance,
+                             bool case_sensitive = true) noexcept -> int;
+
+/**
+ * @class LevenshteinPattern
+ * @brief A string prepared to be compared with many others, e.g. a query against every detected word.
+ *
+ * @details The bit masks of the bit-parallel kernel are computed once for the pattern instead of once per comparison.
+ */
+class LevenshteinPattern {
+ public:
+  /**
+   * @brief Prepares a pattern.
+   *
+   * @param pattern The string compared with the others.
+   * @param case_sensitive Whether letters differing only in case are different characters.
+   */
+  explicit LevenshteinPattern(std::string_view pattern, bool case_sensitive = true);
+
+  /**
+   * @brief Calculates the Levenshtein distance between the pattern and a text, giving up once it exceeds a budget.
+   *
+   * @param text The string compared with the pattern.
+   * @param max_distance The largest distance of interest, negative values are treated as 0.
+   * @return The Levenshtein distance if it is at most max_distance, max_distance + 1 otherwise.
+   */
+  auto Distance(std::string_view text, int max_distance) const noexcept -> int;
+
+  /**
+   * @brief Gets the pattern.
+   */
+  auto GetPattern() const noexcept -> std::string_view;
+
+ private:
+  std::string pattern_;                   // The pattern.
+  bool case_sensitive_;                   // Whether letters differing only in case are different characters.
+  std::array<std::uint64_t, 256> peq_{};  // Positions of every character in the pattern, when it has at most 64.
+};
+
 /**
  * @function ToLower
  * @brief Converts a string to lowercase.
@@ -124,6 +250,22 @@ auto SplitStr(const std::string &s) noexcept -> std::vector<std::string>;
  */
 auto TrimStr(const std::string &s) noexcept -> std::string;
 
+/**
+ * @function ToJsonString
+ * @brief Quotes a string for JSON, escaping quotes, backslashes and control characters.
+ * @param text The string to quote, UTF-8 is kept as is.
+ * @return The quoted string.
+ */
+auto ToJsonString(std::string_view text) -> std::string;
+
+/**
+ * @function FromJsonString
+ * @brief Reads a quoted JSON string, e.g. written by ToJsonString, undoing its escapes.
+ * @param text Text starting with the opening quote, the text after the closing quote is ignored.
+ * @return The string, or std::nullopt if the text does not start with a complete string.
+ */
+auto FromJsonString(std::string_view text) -> std::optional<std::string>;
+
 /**
  * @function GetRectCenter
  * @brief Calculates the center point of a rectangle.
@@ -0,0 +1,119 @@
+#include "textspotter/box_merging.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+/**
+ * @brief Gets how much a detected box is slanted, in degrees from 0 to 90, upside down text counts as upright.
+ */
+static auto GetSlant(const cv::RotatedRect &box) noexcept -> float {
+  if (box.size.area() <= 0) {
+    return 0.0F;
+  }
+  const float angle = std::abs(std::fmod(box.angle, 180.0F));
+  return std::min(angle, 180.0F - angle);
+}
+
+/**
+ * @brief Checks whether two boxes of similar height share a line, and gets the horizontal gap between them.
+ */
+static auto IsOnSameLine(const cv::Rect &a, const cv::Rect &b, const BoxMergeOptions &options, int &gap) noexcept
+    -> bool {
+  const int min_height = std::min(a.height, b.height);
+  const int max_height = std::max(a.height, b.height);
+  const int vertical_overlap = std::min(a.y + a.height, b.y + b.height) - std::max(a.y, b.y);
+  if (min_height <= 0 || static_cast<float>(vertical_overlap) < options.min_vertical_overlap_ * min_height ||
+      static_cast<float>(max_height) > options.max_height_ratio_ * min_height) {
+    return false;
+  }
+  gap = std::max(a.x, b.x) - std::min(a.x + a.width, b.x + b.width);
+  return true;
+}
+
+/**
+ * @brief Checks whether two regions are recognized as one.
+ */
+static auto CanMerge(const cv::Rect &a, const cv::Rect &b, const BoxMergeOptions &options) noexcept -> bool {
+  if ((a & b).area() > 0) {
+    return true;
+  }
+  int gap = 0;
+  if (!IsOnSameLine(a, b, options, gap)) {
+    return false;
+  }
+  const float max_gap = std::max(2.0F * options.tolerance_, options.max_gap_ratio_ * std::max(a.height, b.height));
+  return static_cast<float>(gap) <= max_gap;
+}
+
+auto MergeTextBoxes(const std::vector<TextDetectionResult> &detections, const BoxMergeOptions &options)
+    -> std::vector<TextDetectionResult> {
+  std::vector<TextDetectionResult> regions(detections);
+  std::vector<bool> mergeable;
+  mergeable.reserve(regions.size());
+  for (const auto &region : regions) {
+    mergeable.push_back(GetSlant(region.rotated_box_) < options.max_angle_);
+  }
+
+  // A region growing may reach regions it was tested against before, so merge until nothing changes. A region always
+  // absorbs the ones after it, which keeps the regions in the order of their first box.
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (std::size_t i = 0; i < regions.size(); ++i) {
+      if (!mergeable[i]) {
+        continue;
+      }
+      for (std::size_t j = i + 1; j < regions.size();) {
+        if (!mergeable[j] || !CanMerge(regions[i].bounding_box_, regions[j].bounding_box_, options)) {
+          ++j;
+          continue;
+        }
+        regions[i].bounding_box_ |= regions[j].bounding_box_;
+        regions[i].conf_ = std::max(regions[i].conf_, regions[j].conf_);
+        regions[i].rotated_box_ = cv::RotatedRect();
+        regions.erase(regions.begin() + static_cast<std::ptrdiff_t>(j));
+        mergeable.erase(mergeable.begin() + static_cast<std::ptrdiff_t>(j));
+        // The region grew, the regions already tested against it are tested again.
+        j = i + 1;
+        changed = true;
+      }
+    }
+  }
+  return regions;
+}
+
+auto CalcIoU(const cv::Rect &a, const cv::Rect &b) noexcept -> float {
+  const int intersection = (a & b).area();
+  const int united = a.area() + b.area() - intersection;
+  return united > 0 ? static_cast<float>(intersection) / static_cast<float>(united) : 0.0F;
+}
+
+auto SuppressDuplicateResults(std::vector<DetectReadResult> &results, float iou_threshold) -> std::size_t {
+  std::vector<bool> removed(results.size(), false);
+  for (std::size_t i = 0; i < results.size(); ++i) {
+    for (std::size_t j = i + 1; j < results.size() && !removed[i]; ++j) {
+      if (removed[j] || CalcIoU(results[i].bounding_box_, results[j].bounding_box_) < iou_threshold) {
+        continue;
+      }
+      // On a tie the first result is kept.
+      if (results[j].conf_ > results[i].conf_) {
+        removed[i] = true;
+      } else {
+        removed[j] = true;
+      }
+    }
+  }
+
+  std::size_t kept = 0;
+  for (std::size_t i = 0; i < results.size(); ++i) {
+    if (!removed[i]) {
+      if (kept != i) {
+        results[kept] = std::move(results[i]);
+      }
+      ++kept;
+    }
+  }
+  const auto num_removed = results.size() - kept;
+  results.resize(kept);
+  return num_removed;
+}
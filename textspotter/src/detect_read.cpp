@@ -1,16 +1,23 @@
 #include "textspotter/detect_read.hpp"
 
 #include <fmt/core.h>
+#ifdef _OPENMP
 #include <omp.h>
+#endif
 
+#include <cmath>
 #include <future>
 #include <opencv2/highgui.hpp>
 #include <opencv2/imgproc.hpp>
-#include <thread>
 
+#include "textspotter/box_merging.hpp"
 #include "textspotter/east_detector.hpp"
+#include "textspotter/metrics.hpp"
 #include "textspotter/ocr.hpp"
+#include "textspotter/ocr_cache.hpp"
+#include "textspotter/preprocess.hpp"
 #include "textspotter/result_type.hpp"
+#include "textspotter/thread_pool.hpp"
 #include "textspotter/utility.hpp"
 
 auto inline ExpandROI(const cv::Rect &rect, int tolerance, int image_width, int image_height) -> cv::Rect {
@@ -23,71 +30,267 @@ auto inline ExpandROI(const cv::Rect &rect, int tolerance, int image_width, int
   return {x, y, width, height};
 }
 
+/**
+ * @brief Number of pixels added around every detected region before recognition.
+ */
+constexpr int kRoiTolerance = 5;
+
+/**
+ * @struct PreprocessedImage
+ * @brief The preprocessed image, either computed up front or tile by tile on demand.
+ */
+struct PreprocessedImage {
+  cv::Mat full_;                                  // The whole preprocessed image, in PreprocessMode::kFull.
+  std::unique_ptr<LazyPreprocessor> owned_lazy_;  // The tile cache built for the call, if not given by the options.
+  LazyPreprocessor *lazy_;                        // The tile cache, in PreprocessMode::kLazy.
+};
+
+static auto MakePreprocessedImage(const cv::Mat &image, const DetectReadOptions &options) -> PreprocessedImage {
+  // In lazy mode the tiles are preprocessed on demand, their time is part of the recognition of the regions.
+  const StageTimer timer(options.metrics_, kStagePreprocess);
+  const auto *pipeline = options.preprocess_pipeline_;
+  if (options.preprocess_mode_ == PreprocessMode::kLazy) {
+    if (options.lazy_preprocessor_ != nullptr) {
+      return {cv::Mat(), nullptr, options.lazy_preprocessor_};
+    }
+    auto lazy =
+        pipeline ? std::make_unique<LazyPreprocessor>(image, *pipeline) : std::make_unique<LazyPreprocessor>(image);
+    auto *lazy_ptr = lazy.get();
+    return {cv::Mat(), std::move(lazy), lazy_ptr};
+  }
+  return {pipeline ? pipeline->Run(image) : Preprocess(image), nullptr, nullptr};
+}
+
+/**
+ * @brief Recognizes a region handed to the engine on its own, looking it up in the cache first if there is one.
+ *
+ * @return The results, relative to the region.
+ */
+static auto RecognizeRegion(TesseractApi &tesseract, const cv::Mat &region, OcrCache *cache, Metrics *metrics)
+    -> std::vector<OcrResult> {
+  if (cache == nullptr) {
+    return RecognizeText(tesseract, region, 0);
+  }
+
+  const auto key = OcrCache::MakeKey(region, tesseract.GetConfigKey());
+  if (auto cached = cache->Find(key)) {
+    if (metrics != nullptr) {
+      metrics->Increment(kCounterCacheHits);
+    }
+    return std::move(*cached);
+  }
+  if (metrics != nullptr) {
+    metrics->Increment(kCounterCacheMisses);
+  }
+  auto results = RecognizeText(tesseract, region, 0);
+  cache->Insert(key, results);
+  return results;
+}
+
+/**
+ * @brief Recognizes the text of one detected region of the preprocessed image.
+ *
+ * @details Slanted regions are rectified into an upright crop when enabled by the options, other regions are
+ * recognized within their expanded axis-aligned bounding box.
+ */
+static auto ReadRegion(TesseractApi &tesseract, const PreprocessedImage &preprocessed,
+                       const TextDetectionResult &detection, const DetectReadOptions &options)
+    -> std::vector<OcrResult> {
+  auto *const lazy = preprocessed.lazy_;
+  const cv::Size image_size = lazy ? lazy->GetCanvas().size() : preprocessed.full_.size();
+
+  const auto &rotated = detection.rotated_box_;
+  if (options.rectify_rotated_ && rotated.size.area() > 0) {
+    if (std::abs(FoldAngle(rotated.angle)) >= options.rectify_min_angle_) {
+      if (lazy) {
+        // Covers the padding of the crop and the pixels read by the interpolation.
+        constexpr int margin = 2 * kRoiTolerance + 2;
+        const auto bounds = rotated.boundingRect();
+        lazy->Prepare({bounds.x - margin, bounds.y - margin, bounds.width + 2 * margin, bounds.height + 2 * margin});
+      }
+      const cv::Mat &source = lazy ? lazy->GetCanvas() : preprocessed.full_;
+
+      cv::Mat crop_to_image;
+      const auto crop = RectifyRegion(source, rotated, kRoiTolerance, crop_to_image);
+      auto ocr_results = RecognizeRegion(tesseract, crop, options.ocr_cache_, options.metrics_);
+      for (auto &ocr_res : ocr_results) {
+        ocr_res.bounding_box_ = MapCropToImage(ocr_res.bounding_box_, crop_to_image, image_size);
+      }
+      return ocr_results;
+    }
+  }
+
+  const auto roi = ExpandROI(detection.bounding_box_, kRoiTolerance, image_size.width, image_size.height);
+  if (lazy || options.ocr_cache_ != nullptr) {
+    // In lazy mode only the region is prepared, so the engine must not see the rest of the canvas. The cache needs
+    // results relative to the region.
+    auto ocr_results = RecognizeRegion(tesseract, lazy ? lazy->Prepare(roi) : preprocessed.full_(roi),
+                                       options.ocr_cache_, options.metrics_);
+    for (auto &ocr_res : ocr_results) {
+      ocr_res.bounding_box_ += roi.tl();
+    }
+    return ocr_results;
+  }
+  return RecognizeText(tesseract, preprocessed.full_, 0, roi);
+}
+
+#ifdef _OPENMP
+static auto ToOmpSchedule(OmpSchedule schedule) noexcept -> omp_sched_t {
+  switch (schedule) {
+    case OmpSchedule::kStatic:
+      return omp_sched_static;
+    case OmpSchedule::kGuided:
+      return omp_sched_guided;
+    case OmpSchedule::kDynamic:
+    default:
+      return omp_sched_dynamic;
+  }
+}
+#endif
+
 auto DetectReadText(const cv::Mat &image, std::string_view model_path, bool display) noexcept
     -> std::vector<DetectReadResult> {
-  cv::Mat target = image.clone();
+  return DetectReadText(image, model_path, TesseractPool::Global(), display);
+}
+
+auto DetectReadText(const cv::Mat &image, std::string_view model_path, TesseractPool &tesseract_pool,
+                    bool display) noexcept -> std::vector<DetectReadResult> {
   const EastTextDetector detector(model_path.data());
-  const std::vector<TextDetectionResult> detection_results = detector.detect(image);
+  return DetectReadText(image, detector, tesseract_pool, display);
+}
+
+/**
+ * @brief Merges the detected boxes as configured by the options, slanted boxes are kept apart when they are rectified.
+ */
+static auto MergeRegions(const std::vector<TextDetectionResult> &detection_results, const DetectReadOptions &options)
+    -> std::vector<TextDetectionResult> {
+  auto merge_options = options.box_merge_;
+  if (options.rectify_rotated_) {
+    merge_options.max_angle_ = std::min(merge_options.max_angle_, options.rectify_min_angle_);
+  }
+  return MergeTextBoxes(detection_results, merge_options);
+}
 
-  const auto preprocessed = Preprocess(image);
+auto ReadDetectedText(const cv::Mat &image, const std::vector<TextDetectionResult> &detection_results,
+                      TesseractPool &tesseract_pool, ThreadPool *thread_pool, const DetectReadOptions &options) noexcept
+    -> std::vector<DetectReadResult> {
+  std::vector<TextDetectionResult> merged_results;
+  if (options.merge_boxes_) {
+    merged_results = MergeRegions(detection_results, options);
+  }
+  const auto &regions = options.merge_boxes_ ? merged_results : detection_results;
+
+  const auto preprocessed = MakePreprocessedImage(image, options);
+
+  // Every region writes its own slot, the slots are merged in region order afterwards, so the output does not
+  // depend on the number of threads or on the schedule.
+  const int num_regions = static_cast<int>(regions.size());
+  std::vector<std::vector<OcrResult>> ocr_results(num_regions);
+
+  if (thread_pool != nullptr) {
+    std::vector<std::future<std::vector<OcrResult>>> future_results;
+    future_results.reserve(regions.size());
+    for (const auto &det_res : regions) {
+      future_results.push_back(thread_pool->Submit([&preprocessed, &tesseract_pool, &options, det_res]() {
+        const auto tesseract = tesseract_pool.Acquire();
+        const StageTimer timer(options.metrics_, kStageOcr);
+        return ReadRegion(*tesseract, preprocessed, det_res, options);
+      }));
+    }
+    for (int i = 0; i < num_regions; ++i) {
+      ocr_results[i] = future_results[i].get();
+    }
+  } else {
+#ifdef _OPENMP
+    omp_set_schedule(ToOmpSchedule(options.omp_schedule_), std::max(options.omp_chunk_size_, 1));
+    const int num_threads = options.omp_num_threads_ > 0 ? options.omp_num_threads_ : omp_get_max_threads();
+#pragma omp parallel for schedule(runtime) num_threads(num_threads)
+#endif
+    for (int i = 0; i < num_regions; ++i) {
+      const auto tesseract = tesseract_pool.Acquire();
+      const StageTimer timer(options.metrics_, kStageOcr);
+      ocr_results[i] = ReadRegion(*tesseract, preprocessed, regions[i], options);
+    }
+  }
 
+  std::size_t num_results = 0;
+  for (const auto &ocr_result : ocr_results) {
+    num_results += ocr_result.size();
+  }
   std::vector<DetectReadResult> res;
-#pragma omp parallel for schedule(dynamic)
-  for (const auto &det_res : detection_results) {
-    const auto &[roi, dt_conf] = det_res;
-    const auto &ocr_results =
-        RecognizeText(preprocessed, 0, ExpandROI(roi, 5, image.size().width, image.size().height));
-
-    for (const auto &ocr_res : ocr_results) {
-      const auto &[text_str, box, ocr_conf] = ocr_res;
-      res.push_back({text_str, box});
-      if (display) {
-        cv::rectangle(target, box, cv::Scalar(0, 255, 0));
-      }
+  res.reserve(num_results);
+  for (auto &ocr_result : ocr_results) {
+    for (auto &[text_str, box, ocr_conf] : ocr_result) {
+      res.push_back({std::move(text_str), box, ocr_conf});
     }
   }
+  std::size_t num_duplicates = 0;
+  if (options.duplicate_iou_threshold_ > 0.0F) {
+    num_duplicates = SuppressDuplicateResults(res, options.duplicate_iou_threshold_);
+  }
+  if (options.metrics_ != nullptr) {
+    options.metrics_->Increment(kCounterBoxes, detection_results.size());
+    options.metrics_->Increment(kCounterRegions, regions.size());
+    options.metrics_->Increment(kCounterDuplicates, num_duplicates);
+    options.metrics_->Increment(kCounterWords, res.size());
+  }
+  return res;
+}
 
-  if (display) {
-    cv::imshow("TextSpotter", target);
-    cv::waitKey();
-    cv::destroyAllWindows();
+/**
+ * @brief Detects the text regions of an image, tile by tile if enabled by the options.
+ */
+static auto DetectRegions(const cv::Mat &image, const EastTextDetector &detector, const DetectReadOptions &options)
+    -> std::vector<TextDetectionResult> {
+  const StageTimer timer(options.metrics_, kStageDetect);
+  return options.tiled_detection_ ? detector.detectTiled(image, options.tile_overlap_) : detector.detect(image);
+}
+
+auto DetectTextRegions(const cv::Mat &image, const EastTextDetector &detector,
+                       const DetectReadOptions &options) noexcept -> std::vector<TextDetectionResult> {
+  auto regions = DetectRegions(image, detector, options);
+  return options.merge_boxes_ ? MergeRegions(regions, options) : regions;
+}
+
+/**
+ * @brief Shows the image with the boxes of the results, until a key is pressed.
+ */
+static auto DisplayResults(const cv::Mat &image, const std::vector<DetectReadResult> &results) -> void {
+  cv::Mat target = image.clone();
+  for (const auto &r : results) {
+    cv::rectangle(target, r.bounding_box_, cv::Scalar(0, 255, 0));
   }
+  cv::imshow("TextSpotter", target);
+  cv::waitKey();
+  cv::destroyWindow("TextSpotter");
+}
 
+auto DetectReadText(const cv::Mat &image, const EastTextDetector &detector, TesseractPool &tesseract_pool,
+                    bool display, const DetectReadOptions &options) noexcept -> std::vector<DetectReadResult> {
+  auto res = ReadDetectedText(image, DetectRegions(image, detector, options), tesseract_pool, nullptr, options);
+  if (display) {
+    DisplayResults(image, res);
+  }
   return res;
 }
 
 auto DetectReadTextMultiThread(const cv::Mat &image, std::string_view model_path, bool display) noexcept
     -> std::vector<DetectReadResult> {
-  cv::Mat target = image.clone();
+  return DetectReadTextMultiThread(image, model_path, TesseractPool::Global(), display);
+}
+
+auto DetectReadTextMultiThread(const cv::Mat &image, std::string_view model_path, TesseractPool &tesseract_pool,
+                               bool display) noexcept -> std::vector<DetectReadResult> {
   const EastTextDetector detector(model_path.data());
-  const std::vector<TextDetectionResult> detection_results = detector.detect(image);
-
-  const auto preprocessed = Preprocess(image);
-  std::vector<std::future<std::vector<OcrResult>>> future_results;
-  for (const auto &det_res : detection_results) {
-    const auto &[roi, dt_conf] = det_res;
-    future_results.push_back(std::async(std::launch::async, [&]() {
-      return RecognizeText(preprocessed, 0, ExpandROI(roi, 5, image.size().width, image.size().height));
-    }));
-  }
-
-  std::vector<DetectReadResult> results;
-  for (auto &f : future_results) {
-    auto ocr_results = f.get();
-    for (const auto &res : ocr_results) {
-      const auto &[text, box, conf] = res;
-      results.push_back({text, box});
-      if (display) {
-        cv::rectangle(target, box, cv::Scalar(0, 255, 0));
-      }
-    }
-  }
+  return DetectReadTextMultiThread(image, detector, tesseract_pool, ThreadPool::Global(), display);
+}
 
+auto DetectReadTextMultiThread(const cv::Mat &image, const EastTextDetector &detector, TesseractPool &tesseract_pool,
+                               ThreadPool &thread_pool, bool display, const DetectReadOptions &options) noexcept
+    -> std::vector<DetectReadResult> {
+  auto res = ReadDetectedText(image, DetectRegions(image, detector, options), tesseract_pool, &thread_pool, options);
   if (display) {
-    cv::imshow("TextSpotter", target);
-    cv::waitKey();
-    cv::destroyWindow("TextSpotter");
+    DisplayResults(image, res);
   }
-
-  return results;
+  return res;
 }
@@ -1,33 +1,246 @@
 #include "textspotter/east_detector.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <opencv2/imgproc.hpp>
+
+#include "textspotter/metrics.hpp"
+#include "textspotter/tiling.hpp"
+
+/**
+ * @brief Builds a detection result from a rotated box in image coordinates.
+ */
+static auto ToDetectionResult(const cv::RotatedRect &box, float conf) -> TextDetectionResult {
+  // Vertices are ordered bottom left, top left, top right, bottom right.
+  cv::Point2f vertices[4];
+  box.points(vertices);
+  const cv::Point top_left = vertices[1];
+  const cv::Point bot_right = vertices[3];
+  return {{top_left, bot_right}, conf, box};
+}
+
+/**
+ * @brief Converts a grayscale or BGRA image to BGR, the only layout the network accepts.
+ * @return The image itself if it is BGR already, an empty image if it has another number of channels.
+ */
+static auto ToBgr(const cv::Mat &image) -> cv::Mat {
+  cv::Mat bgr;
+  switch (image.channels()) {
+    case 1:
+      cv::cvtColor(image, bgr, cv::COLOR_GRAY2BGR);
+      return bgr;
+    case 3:
+      return image;
+    case 4:
+      cv::cvtColor(image, bgr, cv::COLOR_BGRA2BGR);
+      return bgr;
+    default:
+      return bgr;
+  }
+}
+
 EastTextDetector::EastTextDetector(const char *model_path, float conf_threshold, float nms_threshold, int width,
                                    int height, double detect_scale, const cv::Scalar &detect_mean, bool swap_rb)
-    : detector_(std::make_unique<cv::dnn::TextDetectionModel_EAST>(model_path)) {
+    : detector_(std::make_unique<cv::dnn::TextDetectionModel_EAST>(model_path)),
+      conf_threshold_(conf_threshold),
+      nms_threshold_(nms_threshold),
+      input_size_(width, height),
+      detect_scale_(detect_scale),
+      detect_mean_(detect_mean),
+      swap_rb_(swap_rb),
+      metrics_(nullptr) {
   detector_->setConfidenceThreshold(conf_threshold);
   detector_->setNMSThreshold(nms_threshold);
   detector_->setInputParams(detect_scale, cv::Size{width, height}, detect_mean, swap_rb);
 }
 
 EastTextDetector::EastTextDetector(std::unique_ptr<cv::dnn::TextDetectionModel_EAST> detector)
-    : detector_(std::move(detector)) {}
+    : detector_(std::move(detector)),
+      conf_threshold_(detector_->getConfidenceThreshold()),
+      nms_threshold_(detector_->getNMSThreshold()),
+      input_size_(640, 320),
+      detect_scale_(1.0),
+      detect_mean_(123.68, 116.78, 103.94),
+      swap_rb_(true),
+      metrics_(nullptr) {}
 
-auto EastTextDetector::detect(const cv::Mat &image) const noexcept -> std::vector<TextDetectionResult> {
+auto EastTextDetector::detect(const cv::Mat &input) const noexcept -> std::vector<TextDetectionResult> {
+  const cv::Mat image = ToBgr(input);
   if (image.empty()) {
     return {};
   }
 
-  std::vector<std::vector<cv::Point>> detections;
+  std::vector<cv::RotatedRect> detections;
   std::vector<float> confidences;
-  detector_->detect(image, detections, confidences);
+  detector_->detectTextRectangles(image, detections, confidences);
 
   std::vector<TextDetectionResult> result;
 
   for (size_t i = 0; i < detections.size(); ++i) {
-    const auto &detection = detections[i];
-    cv::Point top_left = detection[1];
-    cv::Point bot_right = detection[3];
-    result.push_back({{top_left, bot_right}, confidences[i]});
+    result.push_back(ToDetectionResult(detections[i], confidences[i]));
+  }
+
+  return result;
+}
+
+auto EastTextDetector::Warmup() const noexcept -> void {
+  const cv::Mat dummy(input_size_, CV_8UC3, cv::Scalar::all(0));
+  detect(dummy);
+}
+
+auto EastTextDetector::detectBatch(const std::vector<cv::Mat> &images) const noexcept
+    -> std::vector<std::vector<TextDetectionResult>> {
+  std::vector<std::vector<TextDetectionResult>> results(images.size());
+
+  std::vector<cv::Mat> frames;
+  std::vector<size_t> frame_indices;
+  for (size_t i = 0; i < images.size(); ++i) {
+    cv::Mat frame = ToBgr(images[i]);
+    if (!frame.empty()) {
+      frames.push_back(std::move(frame));
+      frame_indices.push_back(i);
+    }
+  }
+  if (frames.empty()) {
+    return results;
+  }
+
+  std::vector<cv::Mat> outputs;
+  {
+    const StageTimer timer(metrics_, kStageEastForward);
+    const cv::Mat blob = cv::dnn::blobFromImages(frames, detect_scale_, input_size_, detect_mean_, swap_rb_, false);
+    // The model converts to the network it wraps, so the batch runs on the already loaded graph.
+    cv::dnn::Net &net = *detector_;
+    net.setInput(blob);
+
+    static const std::vector<cv::String> output_names{"feature_fusion/Conv_7/Sigmoid", "feature_fusion/concat_3"};
+    net.forward(outputs, output_names);
+  }
+  const cv::Mat &scores = outputs[0];
+  const cv::Mat &geometry = outputs[1];
+
+  const StageTimer timer(metrics_, kStageEastDecode);
+  for (size_t b = 0; b < frames.size(); ++b) {
+    std::vector<cv::RotatedRect> boxes;
+    std::vector<float> confidences;
+    decode(scores, geometry, static_cast<int>(b), boxes, confidences);
+
+    std::vector<int> indices;
+    cv::dnn::NMSBoxes(boxes, confidences, conf_threshold_, nms_threshold_, indices);
+
+    // Map the boxes from network input coordinates back to the image, the same way the model does in detect().
+    const float ratio_x = static_cast<float>(frames[b].cols) / static_cast<float>(input_size_.width);
+    const float ratio_y = static_cast<float>(frames[b].rows) / static_cast<float>(input_size_.height);
+
+    auto &result = results[frame_indices[b]];
+    for (const int index : indices) {
+      cv::RotatedRect box = boxes[index];
+      box.center.x *= ratio_x;
+      box.center.y *= ratio_y;
+      box.size.width *= ratio_x;
+      box.size.height *= ratio_y;
+      result.push_back(ToDetectionResult(box, confidences[index]));
+    }
   }
 
+  return results;
+}
+
+auto EastTextDetector::detectTiled(const cv::Mat &input, int overlap, std::size_t max_batch_size) const noexcept
+    -> std::vector<TextDetectionResult> {
+  // Converted once here rather than tile by tile in detectBatch().
+  const cv::Mat image = ToBgr(input);
+  if (image.empty()) {
+    return {};
+  }
+  if (image.cols <= input_size_.width && image.rows <= input_size_.height) {
+    return detect(image);
+  }
+
+  const int tile_width = std::min(input_size_.width, image.cols);
+  const int tile_height = std::min(input_size_.height, image.rows);
+  overlap = std::clamp(overlap, 0, std::min(tile_width, tile_height) / 2);
+
+  std::vector<cv::Rect> tiles;
+  for (const int y : TileOrigins(image.rows, tile_height, overlap)) {
+    for (const int x : TileOrigins(image.cols, tile_width, overlap)) {
+      tiles.emplace_back(x, y, tile_width, tile_height);
+    }
+  }
+
+  std::vector<cv::RotatedRect> boxes;
+  std::vector<float> confidences;
+  max_batch_size = std::max<std::size_t>(max_batch_size, 1);
+  for (std::size_t first = 0; first < tiles.size(); first += max_batch_size) {
+    const std::size_t last = std::min(tiles.size(), first + max_batch_size);
+    std::vector<cv::Mat> views;
+    for (std::size_t i = first; i < last; ++i) {
+      views.push_back(image(tiles[i]));
+    }
+
+    const auto batch_results = detectBatch(views);
+    for (std::size_t i = first; i < last; ++i) {
+      const auto &tile = tiles[i];
+      for (const auto &detection : batch_results[i - first]) {
+        if (IsHeldByNeighbour(detection.rotated_box_.boundingRect(), tile, image.size(), overlap)) {
+          continue;
+        }
+        cv::RotatedRect box = detection.rotated_box_;
+        box.center.x += static_cast<float>(tile.x);
+        box.center.y += static_cast<float>(tile.y);
+        boxes.push_back(box);
+        confidences.push_back(detection.conf_);
+      }
+    }
+  }
+
+  // Text longer than the overlap is still found by several tiles.
+  const StageTimer timer(metrics_, kStageEastDecode);
+  std::vector<int> indices;
+  cv::dnn::NMSBoxes(boxes, confidences, conf_threshold_, nms_threshold_, indices);
+
+  std::vector<TextDetectionResult> result;
+  result.reserve(indices.size());
+  for (const int index : indices) {
+    result.push_back(ToDetectionResult(boxes[index], confidences[index]));
+  }
   return result;
 }
+
+auto EastTextDetector::decode(const cv::Mat &scores, const cv::Mat &geometry, int index,
+                              std::vector<cv::RotatedRect> &boxes, std::vector<float> &confidences) const -> void {
+  const int height = scores.size[2];
+  const int width = scores.size[3];
+
+  for (int y = 0; y < height; ++y) {
+    const float *scores_data = scores.ptr<float>(index, 0, y);
+    const float *x0_data = geometry.ptr<float>(index, 0, y);
+    const float *x1_data = geometry.ptr<float>(index, 1, y);
+    const float *x2_data = geometry.ptr<float>(index, 2, y);
+    const float *x3_data = geometry.ptr<float>(index, 3, y);
+    const float *angles_data = geometry.ptr<float>(index, 4, y);
+
+    for (int x = 0; x < width; ++x) {
+      const float score = scores_data[x];
+      if (score < conf_threshold_) {
+        continue;
+      }
+
+      // The maps are 4 times smaller than the network input.
+      const float offset_x = x * 4.0F;
+      const float offset_y = y * 4.0F;
+      const float angle = angles_data[x];
+      const float cos_a = std::cos(angle);
+      const float sin_a = std::sin(angle);
+      const float h = x0_data[x] + x2_data[x];
+      const float w = x1_data[x] + x3_data[x];
+
+      const cv::Point2f offset(offset_x + cos_a * x1_data[x] + sin_a * x2_data[x],
+                               offset_y - sin_a * x1_data[x] + cos_a * x2_data[x]);
+      const cv::Point2f p1 = cv::Point2f(-sin_a * h, -cos_a * h) + offset;
+      const cv::Point2f p3 = cv::Point2f(-cos_a * w, sin_a * w) + offset;
+      boxes.emplace_back(0.5F * (p1 + p3), cv::Size2f(w, h), -angle * 180.0F / static_cast<float>(CV_PI));
+      confidences.push_back(score);
+    }
+  }
+}
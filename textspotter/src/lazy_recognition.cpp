@@ -0,0 +1,92 @@
+#include "textspotter/lazy_recognition.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+#include "textspotter/text_matching.hpp"
+#include "textspotter/utility.hpp"
+
+auto RankRegion(const cv::Rect &box, std::size_t target_length, const cv::Point &last_hit, double diagonal) noexcept
+    -> double {
+  const double expected_width = std::max(0.5 * box.height * static_cast<double>(target_length), 1.0);
+  const double ratio = std::max(box.width, 1) / expected_width;
+  double cost = ratio < 1.0 ? -std::log(ratio) : 0.5 * std::log(ratio);
+  if (last_hit.x >= 0) {
+    const cv::Point offset = GetRectCenter(box) - last_hit;
+    cost += std::hypot(offset.x, offset.y) / diagonal;
+  }
+  return cost;
+}
+
+LazyRecognizer::LazyRecognizer() : num_read_(0), last_hit_(-1, -1) {}
+
+auto LazyRecognizer::Reset(std::vector<TextDetectionResult> regions) -> void {
+  regions_ = std::move(regions);
+  read_.assign(regions_.size(), false);
+  num_read_ = 0;
+  results_.clear();
+  index_.Clear();
+}
+
+auto LazyRecognizer::ClearLastHit() noexcept -> void { last_hit_ = {-1, -1}; }
+
+auto LazyRecognizer::GetUnreadRegions() const -> std::vector<std::size_t> {
+  std::vector<std::size_t> unread;
+  for (std::size_t i = 0; i < regions_.size(); ++i) {
+    if (!read_[i]) {
+      unread.push_back(i);
+    }
+  }
+  return unread;
+}
+
+auto LazyRecognizer::Read(const std::vector<std::size_t> &indices, const Reader &read) -> void {
+  if (indices.empty()) {
+    return;
+  }
+
+  std::vector<TextDetectionResult> regions;
+  regions.reserve(indices.size());
+  for (const auto i : indices) {
+    regions.push_back(regions_[i]);
+    read_[i] = true;
+  }
+  num_read_ += indices.size();
+
+  auto words = read(regions);
+  results_.insert(results_.end(), std::make_move_iterator(words.begin()), std::make_move_iterator(words.end()));
+  index_.Build(results_);
+}
+
+auto LazyRecognizer::Match(std::string_view target, const cv::Size &image_size, std::size_t batch_size,
+                           float min_score, const Reader &read) -> MatchResult {
+  auto best = MatchTarget(results_, index_, target);
+
+  auto pending = GetUnreadRegions();
+  if (best.score_ < min_score && !pending.empty()) {
+    const auto length = std::max<std::size_t>(target.size(), 1);
+    const double diagonal = std::max(std::hypot(image_size.width, image_size.height), 1.0);
+    std::vector<double> costs(regions_.size(), 0.0);
+    for (const auto i : pending) {
+      costs[i] = RankRegion(regions_[i].bounding_box_, length, last_hit_, diagonal);
+    }
+    std::stable_sort(pending.begin(), pending.end(), [&costs](auto a, auto b) { return costs[a] < costs[b]; });
+
+    batch_size = std::max<std::size_t>(batch_size, 1);
+    for (std::size_t start = 0; start < pending.size() && best.score_ < min_score; start += batch_size) {
+      const auto end = std::min(start + batch_size, pending.size());
+      Read(std::vector<std::size_t>(pending.begin() + static_cast<std::ptrdiff_t>(start),
+                                    pending.begin() + static_cast<std::ptrdiff_t>(end)),
+           read);
+      best = MatchTarget(results_, index_, target);
+    }
+  }
+
+  if (best.point_.x >= 0) {
+    last_hit_ = best.point_;
+  }
+  return best;
+}
+
+auto LazyRecognizer::ReadAll(const Reader &read) -> void { Read(GetUnreadRegions(), read); }
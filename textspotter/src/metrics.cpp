@@ -0,0 +1,195 @@
+#include "textspotter/metrics.hpp"
+
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+
+#include "textspotter/utility.hpp"
+
+/**
+ * @brief Upper bound of the first bucket, in seconds, every next bound is twice the previous one.
+ */
+constexpr double kFirstBucketBound = 1e-5;
+
+/**
+ * @brief Turns a metric name into a valid Prometheus name, every invalid character becomes an underscore.
+ */
+static auto ToPrometheusName(std::string_view name) -> std::string {
+  std::string result(name);
+  for (auto &c : result) {
+    const bool valid = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+    if (!valid) {
+      c = '_';
+    }
+  }
+  return result;
+}
+
+auto Histogram::GetBucketBound(std::size_t bucket) noexcept -> double {
+  if (bucket + 1 >= kNumBuckets) {
+    return std::numeric_limits<double>::infinity();
+  }
+  return std::ldexp(kFirstBucketBound, static_cast<int>(bucket));
+}
+
+auto Histogram::Record(double seconds) noexcept -> void {
+  seconds = std::max(seconds, 0.0);
+  std::size_t bucket = 0;
+  while (seconds > GetBucketBound(bucket)) {
+    ++bucket;
+  }
+  ++buckets_[bucket];
+
+  min_ = count_ == 0 ? seconds : std::min(min_, seconds);
+  max_ = std::max(max_, seconds);
+  sum_ += seconds;
+  ++count_;
+}
+
+auto Histogram::GetQuantile(double q) const noexcept -> double {
+  if (count_ == 0) {
+    return 0.0;
+  }
+
+  const double rank = std::clamp(q, 0.0, 1.0) * static_cast<double>(count_);
+  std::uint64_t below = 0;
+  for (std::size_t bucket = 0; bucket < kNumBuckets; ++bucket) {
+    if (buckets_[bucket] == 0 || static_cast<double>(below + buckets_[bucket]) < rank) {
+      below += buckets_[bucket];
+      continue;
+    }
+    // Assume the durations are spread evenly over the bucket, the last bucket ends at the longest duration.
+    const double lower = bucket == 0 ? 0.0 : GetBucketBound(bucket - 1);
+    const double upper = bucket + 1 == kNumBuckets ? max_ : GetBucketBound(bucket);
+    const double fraction = (rank - static_cast<double>(below)) / static_cast<double>(buckets_[bucket]);
+    return std::clamp(lower + (upper - lower) * fraction, GetMin(), max_);
+  }
+  return max_;
+}
+
+auto Metrics::Record(std::string_view stage, double seconds) -> void {
+  const std::lock_guard lock(mutex_);
+  auto it = histograms_.find(stage);
+  if (it == histograms_.end()) {
+    it = histograms_.emplace(std::string(stage), Histogram()).first;
+  }
+  it->second.Record(seconds);
+}
+
+auto Metrics::Increment(std::string_view counter, std::uint64_t value) -> void {
+  const std::lock_guard lock(mutex_);
+  auto it = counters_.find(counter);
+  if (it == counters_.end()) {
+    it = counters_.emplace(std::string(counter), 0).first;
+  }
+  it->second += value;
+}
+
+auto Metrics::GetHistogram(std::string_view stage) const -> Histogram {
+  const std::lock_guard lock(mutex_);
+  const auto it = histograms_.find(stage);
+  return it == histograms_.end() ? Histogram() : it->second;
+}
+
+auto Metrics::GetCounter(std::string_view counter) const -> std::uint64_t {
+  const std::lock_guard lock(mutex_);
+  const auto it = counters_.find(counter);
+  return it == counters_.end() ? 0 : it->second;
+}
+
+auto Metrics::GetHistograms() const -> std::vector<std::pair<std::string, Histogram>> {
+  const std::lock_guard lock(mutex_);
+  return {histograms_.begin(), histograms_.end()};
+}
+
+auto Metrics::GetCounters() const -> std::vector<std::pair<std::string, std::uint64_t>> {
+  const std::lock_guard lock(mutex_);
+  return {counters_.begin(), counters_.end()};
+}
+
+auto Metrics::Reset() -> void {
+  const std::lock_guard lock(mutex_);
+  histograms_.clear();
+  counters_.clear();
+}
+
+auto Metrics::Export(MetricsFormat format) const -> std::string {
+  // Export a snapshot, so that the lock is not held while formatting.
+  const auto histograms = GetHistograms();
+  const auto counters = GetCounters();
+
+  std::string out;
+  if (format == MetricsFormat::kPrometheus) {
+    for (const auto &[name, value] : counters) {
+      const auto metric = "textspotter_" + ToPrometheusName(name) + "_total";
+      out += fmt::format("# TYPE {} counter\n{} {}\n", metric, metric, value);
+    }
+    for (const auto &[name, histogram] : histograms) {
+      const auto metric = "textspotter_" + ToPrometheusName(name) + "_seconds";
+      out += fmt::format("# TYPE {} histogram\n", metric);
+      // Prometheus buckets are cumulative.
+      std::uint64_t cumulative = 0;
+      for (std::size_t bucket = 0; bucket + 1 < Histogram::kNumBuckets; ++bucket) {
+        cumulative += histogram.GetBuckets()[bucket];
+        out += fmt::format("{}_bucket{{le=\"{}\"}} {}\n", metric, Histogram::GetBucketBound(bucket), cumulative);
+      }
+      out += fmt::format("{}_bucket{{le=\"+Inf\"}} {}\n", metric, histogram.GetCount());
+      out += fmt::format("{}_sum {}\n{}_count {}\n", metric, histogram.GetSum(), metric, histogram.GetCount());
+    }
+    return out;
+  }
+
+  out += "{\"counters\":{";
+  for (std::size_t i = 0; i < counters.size(); ++i) {
+    out += fmt::format("{}{}:{}", i == 0 ? "" : ",", ToJsonString(counters[i].first), counters[i].second);
+  }
+  out += "},\"histograms\":{";
+  for (std::size_t i = 0; i < histograms.size(); ++i) {
+    const auto &[name, histogram] = histograms[i];
+    out += fmt::format(
+        "{}{}:{{\"count\":{},\"sum\":{},\"min\":{},\"max\":{},\"mean\":{},\"p50\":{},\"p90\":{},\"p99\":{},"
+        "\"buckets\":[",
+        i == 0 ? "" : ",", ToJsonString(name), histogram.GetCount(), histogram.GetSum(), histogram.GetMin(),
+        histogram.GetMax(), histogram.GetMean(), histogram.GetQuantile(0.5), histogram.GetQuantile(0.9),
+        histogram.GetQuantile(0.99));
+    // Only the buckets holding durations are listed, each with its upper bound.
+    bool first = true;
+    for (std::size_t bucket = 0; bucket < Histogram::kNumBuckets; ++bucket) {
+      const auto count = histogram.GetBuckets()[bucket];
+      if (count == 0) {
+        continue;
+      }
+      const auto bound = bucket + 1 == Histogram::kNumBuckets ? std::string("\"+Inf\"")
+                                                              : fmt::format("{}", Histogram::GetBucketBound(bucket));
+      out += fmt::format("{}{{\"le\":{},\"count\":{}}}", first ? "" : ",", bound, count);
+      first = false;
+    }
+    out += "]}";
+  }
+  out += "}}\n";
+  return out;
+}
+
+auto Metrics::Save(std::string_view path, MetricsFormat format) const -> bool {
+  std::ofstream out(std::string(path), std::ios::trunc);
+  if (!out) {
+    return false;
+  }
+  out << Export(format);
+  return static_cast<bool>(out);
+}
+
+StageTimer::StageTimer(Metrics *metrics, std::string_view stage) noexcept : metrics_(metrics), stage_(stage) {
+  if (metrics_ != nullptr) {
+    start_ = std::chrono::steady_clock::now();
+  }
+}
+
+StageTimer::~StageTimer() {
+  if (metrics_ != nullptr) {
+    metrics_->Record(stage_, std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count());
+  }
+}
@@ -1,13 +1,65 @@
 #include "textspotter/ocr.hpp"
 
+#include <algorithm>
+#include <thread>
+
+#include "textspotter/ocr_cache.hpp"
 #include "textspotter/utility.hpp"
 
-TesseractApi::TesseractApi(const char *language) : api_(std::make_unique<tesseract::TessBaseAPI>()) {
-  if (api_->Init(nullptr, language) == -1) {
+auto RecognitionProfile::Default() -> RecognitionProfile { return {}; }
+
+auto RecognitionProfile::SingleLine() -> RecognitionProfile {
+  RecognitionProfile profile;
+  profile.page_seg_mode_ = tesseract::PSM_SINGLE_LINE;
+  profile.engine_mode_ = tesseract::OEM_LSTM_ONLY;
+  return profile;
+}
+
+auto RecognitionProfile::SingleWord() -> RecognitionProfile {
+  RecognitionProfile profile;
+  profile.page_seg_mode_ = tesseract::PSM_SINGLE_WORD;
+  profile.engine_mode_ = tesseract::OEM_LSTM_ONLY;
+  return profile;
+}
+
+auto RecognitionProfile::RawLine() -> RecognitionProfile {
+  RecognitionProfile profile;
+  profile.page_seg_mode_ = tesseract::PSM_RAW_LINE;
+  profile.engine_mode_ = tesseract::OEM_LSTM_ONLY;
+  profile.load_dictionaries_ = false;
+  profile.penalize_non_dictionary_words_ = false;
+  return profile;
+}
+
+auto RecognitionProfile::GetKey() const noexcept -> std::uint64_t {
+  const std::int32_t settings[] = {static_cast<std::int32_t>(page_seg_mode_), static_cast<std::int32_t>(engine_mode_),
+                                   load_dictionaries_, penalize_non_dictionary_words_};
+  const auto key = OcrCache::HashBytes(settings, sizeof(settings), 0);
+  return OcrCache::HashBytes(char_whitelist_.data(), char_whitelist_.size(), key);
+}
+
+TesseractApi::TesseractApi(const char *language, const RecognitionProfile &profile)
+    : api_(std::make_unique<tesseract::TessBaseAPI>()), config_key_(0) {
+  // The word lists are loaded by Init(), whether to load them must be known beforehand.
+  const std::vector<std::string> init_names = {"load_system_dawg", "load_freq_dawg"};
+  const std::vector<std::string> init_values(init_names.size(), profile.load_dictionaries_ ? "1" : "0");
+  if (api_->Init(nullptr, language, profile.engine_mode_, nullptr, 0, &init_names, &init_values, false) == -1) {
     throw std::runtime_error{"cannot initialize tesseract api"};
   }
   api_->SetVariable("debug_file", "tesseract.log");
   // api_->SetVariable("lstm_choice_mode", "2");
+
+  api_->SetPageSegMode(profile.page_seg_mode_);
+  if (!profile.penalize_non_dictionary_words_) {
+    api_->SetVariable("language_model_penalty_non_dict_word", "0");
+    api_->SetVariable("language_model_penalty_non_freq_dict_word", "0");
+  }
+  if (!profile.char_whitelist_.empty()) {
+    api_->SetVariable("tessedit_char_whitelist", profile.char_whitelist_.c_str());
+  }
+
+  const std::string languages = api_->GetInitLanguagesAsString();
+  config_key_ = OcrCache::HashBytes(languages.data(), languages.size(), profile.GetKey());
 }
 
 TesseractApi::~TesseractApi() { api_->End(); }
@@ -18,20 +70,36 @@ auto RecognizeText(const cv::Mat &image, float conf_threshold, std::optional<cv:
     return {};
   }
 
-  const auto tesseract = TesseractApi();
+  auto tesseract = TesseractApi();
+  return RecognizeText(tesseract, image, conf_threshold, roi);
+}
 
-  tesseract.api_->SetImage(image.data, image.size().width, image.size().height, image.channels(), image.step1());
-  if (roi != std::nullopt) {
-    tesseract.api_->SetRectangle(roi->x, roi->y, roi->width, roi->height);
+auto RecognizeText(TesseractApi &tesseract, const cv::Mat &image, float conf_threshold,
+                   std::optional<cv::Rect> roi) noexcept -> std::vector<OcrResult> {
+  if (image.empty()) {
+    return {};
+  }
+
+  const cv::Rect image_bounds(0, 0, image.cols, image.rows);
+  const cv::Rect bounds = roi != std::nullopt ? (*roi & image_bounds) : image_bounds;
+  if (bounds.empty()) {
+    return {};
   }
+
+  // The engine copies the pixels it is given into its own image, so hand it a view of the region only rather than
+  // the whole image with a rectangle: the cost then follows the size of the region, not of the image.
+  const cv::Mat view = image(bounds);
+  tesseract.api_->SetImage(view.data, view.cols, view.rows, static_cast<int>(view.elemSize()),
+                           static_cast<int>(view.step[0]));
   tesseract.api_->Recognize(nullptr);
 
   std::vector<OcrResult> result;
 
-  const auto it = tesseract.api_->GetIterator();
+  const std::unique_ptr<tesseract::ResultIterator> it(tesseract.api_->GetIterator());
   constexpr tesseract::PageIteratorLevel level = tesseract::RIL_WORD;
 
   if (!it) {
+    tesseract.api_->Clear();
     return {};
   }
 
@@ -42,20 +110,119 @@ auto RecognizeText(const cv::Mat &image, float conf_threshold, std::optional<cv:
       continue;
     }
 
-    const char *word = it->GetUTF8Text(level);
+    const std::unique_ptr<const char[]> word(it->GetUTF8Text(level));
     if (word == nullptr) {
       continue;
     }
-    const std::string word_str(word);
+    const std::string word_str(word.get());
     if (word_str.empty()) {
       continue;
     }
 
     int x1, y1, x2, y2;
     it->BoundingBox(level, &x1, &y1, &x2, &y2);
-    const cv::Rect box(cv::Point(x1, y1), cv::Point(x2, y2));
-    result.push_back({word, box, conf});
+    // Boxes are relative to the region, map them back to the image.
+    const cv::Rect box(cv::Point(x1, y1) + bounds.tl(), cv::Point(x2, y2) + bounds.tl());
+    result.push_back({word_str, box, conf});
   } while (it->Next(level));
 
+  // Release the recognition results, the engine itself stays initialized for the next call.
+  tesseract.api_->Clear();
+
   return result;
 }
+
+TesseractPool::Handle::Handle(TesseractPool *pool, std::unique_ptr<TesseractApi> api) noexcept
+    : pool_(pool), api_(std::move(api)) {}
+
+TesseractPool::Handle::Handle(Handle &&other) noexcept : pool_(other.pool_), api_(std::move(other.api_)) {
+  other.pool_ = nullptr;
+}
+
+auto TesseractPool::Handle::operator=(Handle &&other) noexcept -> Handle & {
+  if (this != &other) {
+    if (pool_ != nullptr && api_ != nullptr) {
+      pool_->Release(std::move(api_));
+    }
+    pool_ = other.pool_;
+    api_ = std::move(other.api_);
+    other.pool_ = nullptr;
+  }
+  return *this;
+}
+
+TesseractPool::Handle::~Handle() {
+  if (pool_ != nullptr && api_ != nullptr) {
+    pool_->Release(std::move(api_));
+  }
+}
+
+TesseractPool::TesseractPool(std::size_t size, std::string_view language, RecognitionProfile profile)
+    : size_(size == 0 ? std::max(1U, std::thread::hardware_concurrency()) : size),
+      language_(language),
+      profile_(std::move(profile)),
+      created_(0) {
+  idle_.reserve(size_);
+}
+
+auto TesseractPool::Acquire() -> Handle {
+  std::unique_lock lock(mutex_);
+  cv_.wait(lock, [this] { return !idle_.empty() || created_ < size_; });
+
+  if (!idle_.empty()) {
+    auto api = std::move(idle_.back());
+    idle_.pop_back();
+    return {this, std::move(api)};
+  }
+
+  // Initializing an engine loads the language data, do it without holding the lock.
+  ++created_;
+  lock.unlock();
+  try {
+    return {this, std::make_unique<TesseractApi>(language_.c_str(), profile_)};
+  } catch (...) {
+    lock.lock();
+    --created_;
+    lock.unlock();
+    cv_.notify_one();
+    throw;
+  }
+}
+
+auto TesseractPool::Warmup() -> void {
+  while (true) {
+    {
+      const std::lock_guard lock(mutex_);
+      if (created_ >= size_) {
+        return;
+      }
+      ++created_;
+    }
+
+    std::unique_ptr<TesseractApi> api;
+    try {
+      api = std::make_unique<TesseractApi>(language_.c_str(), profile_);
+    } catch (...) {
+      {
+        const std::lock_guard lock(mutex_);
+        --created_;
+      }
+      cv_.notify_one();
+      throw;
+    }
+    Release(std::move(api));
+  }
+}
+
+auto TesseractPool::Global() -> TesseractPool & {
+  static TesseractPool pool;
+  return pool;
+}
+
+auto TesseractPool::Release(std::unique_ptr<TesseractApi> api) noexcept -> void {
+  {
+    const std::lock_guard lock(mutex_);
+    idle_.push_back(std::move(api));
+  }
+  cv_.notify_one();
+}
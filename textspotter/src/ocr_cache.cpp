@@ -0,0 +1,201 @@
+#include "textspotter/ocr_cache.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <string>
+
+namespace {
+constexpr char kFileMagic[8] = {'T', 'S', 'O', 'C', 'R', 'C', '0', '1'};
+constexpr std::uint64_t kPrime = 0x100000001b3ULL;
+
+template <typename T>
+auto WriteValue(std::ofstream &out, const T &value) -> void {
+  out.write(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+template <typename T>
+auto ReadValue(std::ifstream &in, T &value) -> bool {
+  return static_cast<bool>(in.read(reinterpret_cast<char *>(&value), sizeof(value)));
+}
+}  // namespace
+
+OcrCache::OcrCache(std::size_t capacity_bytes)
+    : capacity_bytes_(capacity_bytes), used_bytes_(0), hits_(0), misses_(0) {}
+
+auto OcrCache::Find(std::uint64_t key) -> std::optional<std::vector<OcrResult>> {
+  const std::lock_guard lock(mutex_);
+  const auto it = index_.find(key);
+  if (it == index_.end()) {
+    ++misses_;
+    return std::nullopt;
+  }
+  ++hits_;
+  entries_.splice(entries_.begin(), entries_, it->second);
+  return it->second->second;
+}
+
+auto OcrCache::Insert(std::uint64_t key, std::vector<OcrResult> results) -> void {
+  const std::lock_guard lock(mutex_);
+  InsertLocked(key, std::move(results));
+}
+
+auto OcrCache::InsertLocked(std::uint64_t key, std::vector<OcrResult> results) -> void {
+  if (const auto it = index_.find(key); it != index_.end()) {
+    used_bytes_ -= EntrySize(*it->second);
+    entries_.erase(it->second);
+    index_.erase(it);
+  }
+
+  entries_.emplace_front(key, std::move(results));
+  index_[key] = entries_.begin();
+  used_bytes_ += EntrySize(entries_.front());
+
+  while (used_bytes_ > capacity_bytes_ && !entries_.empty()) {
+    const auto &oldest = entries_.back();
+    used_bytes_ -= EntrySize(oldest);
+    index_.erase(oldest.first);
+    entries_.pop_back();
+  }
+}
+
+auto OcrCache::Clear() -> void {
+  const std::lock_guard lock(mutex_);
+  entries_.clear();
+  index_.clear();
+  used_bytes_ = 0;
+}
+
+auto OcrCache::GetHits() const noexcept -> std::size_t {
+  const std::lock_guard lock(mutex_);
+  return hits_;
+}
+
+auto OcrCache::GetMisses() const noexcept -> std::size_t {
+  const std::lock_guard lock(mutex_);
+  return misses_;
+}
+
+auto OcrCache::Size() const noexcept -> std::size_t {
+  const std::lock_guard lock(mutex_);
+  return entries_.size();
+}
+
+auto OcrCache::GetMemoryUsage() const noexcept -> std::size_t {
+  const std::lock_guard lock(mutex_);
+  return used_bytes_;
+}
+
+auto OcrCache::Save(std::string_view path) const -> bool {
+  std::ofstream out(std::string(path), std::ios::binary | std::ios::trunc);
+  if (!out) {
+    return false;
+  }
+
+  const std::lock_guard lock(mutex_);
+  out.write(kFileMagic, sizeof(kFileMagic));
+  WriteValue(out, static_cast<std::uint64_t>(entries_.size()));
+  // Least recently used first, so that loading the file restores the same order.
+  for (auto it = entries_.rbegin(); it != entries_.rend(); ++it) {
+    const auto &[key, results] = *it;
+    WriteValue(out, key);
+    WriteValue(out, static_cast<std::uint32_t>(results.size()));
+    for (const auto &[text, box, conf] : results) {
+      WriteValue(out, static_cast<std::uint32_t>(text.size()));
+      out.write(text.data(), static_cast<std::streamsize>(text.size()));
+      WriteValue(out, static_cast<std::int32_t>(box.x));
+      WriteValue(out, static_cast<std::int32_t>(box.y));
+      WriteValue(out, static_cast<std::int32_t>(box.width));
+      WriteValue(out, static_cast<std::int32_t>(box.height));
+      WriteValue(out, conf);
+    }
+  }
+  return static_cast<bool>(out);
+}
+
+auto OcrCache::Load(std::string_view path) -> bool {
+  std::ifstream in(std::string(path), std::ios::binary);
+  if (!in) {
+    return false;
+  }
+
+  char magic[sizeof(kFileMagic)];
+  if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, kFileMagic, sizeof(kFileMagic)) != 0) {
+    return false;
+  }
+
+  std::uint64_t num_entries;
+  if (!ReadValue(in, num_entries)) {
+    return false;
+  }
+
+  // Read everything before touching the cache, so that a truncated file leaves it unchanged.
+  std::vector<Entry> entries;
+  for (std::uint64_t i = 0; i < num_entries; ++i) {
+    Entry entry;
+    std::uint32_t num_results;
+    if (!ReadValue(in, entry.first) || !ReadValue(in, num_results)) {
+      return false;
+    }
+    for (std::uint32_t j = 0; j < num_results; ++j) {
+      std::uint32_t text_size;
+      if (!ReadValue(in, text_size)) {
+        return false;
+      }
+      OcrResult result;
+      result.text_.resize(text_size);
+      std::int32_t x, y, width, height;
+      if (!in.read(result.text_.data(), text_size) || !ReadValue(in, x) || !ReadValue(in, y) ||
+          !ReadValue(in, width) || !ReadValue(in, height) || !ReadValue(in, result.conf_)) {
+        return false;
+      }
+      result.bounding_box_ = {x, y, width, height};
+      entry.second.push_back(std::move(result));
+    }
+    entries.push_back(std::move(entry));
+  }
+
+  const std::lock_guard lock(mutex_);
+  for (auto &[key, results] : entries) {
+    InsertLocked(key, std::move(results));
+  }
+  return true;
+}
+
+auto OcrCache::MakeKey(const cv::Mat &region, std::uint64_t config_key) noexcept -> std::uint64_t {
+  const std::int32_t header[3] = {region.cols, region.rows, region.type()};
+  std::uint64_t key = HashBytes(header, sizeof(header), config_key);
+  const std::size_t row_size = region.cols * region.elemSize();
+  for (int y = 0; y < region.rows; ++y) {
+    key = HashBytes(region.ptr(y), row_size, key);
+  }
+  return key;
+}
+
+auto OcrCache::HashBytes(const void *data, std::size_t size, std::uint64_t seed) noexcept -> std::uint64_t {
+  // FNV-1a style mixing of 8 byte words, followed by a final avalanche so that close inputs spread well.
+  const auto *bytes = static_cast<const unsigned char *>(data);
+  std::uint64_t hash = seed ^ 0xcbf29ce484222325ULL;
+  std::size_t i = 0;
+  for (; i + sizeof(std::uint64_t) <= size; i += sizeof(std::uint64_t)) {
+    std::uint64_t word;
+    std::memcpy(&word, bytes + i, sizeof(word));
+    hash = (hash ^ word) * kPrime;
+    hash ^= hash >> 29;
+  }
+  for (; i < size; ++i) {
+    hash = (hash ^ bytes[i]) * kPrime;
+  }
+  hash ^= size;
+  hash *= 0xff51afd7ed558ccdULL;
+  hash ^= hash >> 33;
+  return hash;
+}
+
+auto OcrCache::EntrySize(const Entry &entry) noexcept -> std::size_t {
+  // Approximation of the list node, the index node and the result vector.
+  std::size_t size = sizeof(Entry) + 4 * sizeof(void *) + sizeof(std::uint64_t);
+  for (const auto &result : entry.second) {
+    size += sizeof(OcrResult) + result.text_.capacity();
+  }
+  return size;
+}
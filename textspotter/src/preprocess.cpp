@@ -0,0 +1,196 @@
+#include "textspotter/preprocess.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <opencv2/imgproc.hpp>
+#include <opencv2/photo.hpp>
+
+#include "textspotter/utility.hpp"
+
+PreprocessPipeline::PreprocessPipeline() = default;
+
+PreprocessPipeline::PreprocessPipeline(PreprocessPipeline &&other) noexcept : stages_(std::move(other.stages_)) {
+  const std::lock_guard lock(other.timings_mutex_);
+  timings_ = std::move(other.timings_);
+  other.stages_.clear();
+  other.timings_.clear();
+}
+
+auto PreprocessPipeline::operator=(PreprocessPipeline &&other) noexcept -> PreprocessPipeline & {
+  if (this != &other) {
+    const std::scoped_lock lock(timings_mutex_, other.timings_mutex_);
+    stages_ = std::move(other.stages_);
+    timings_ = std::move(other.timings_);
+    other.stages_.clear();
+    other.timings_.clear();
+  }
+  return *this;
+}
+
+auto PreprocessPipeline::AddStage(std::string_view name, Stage stage) -> PreprocessPipeline & {
+  stages_.emplace_back(std::string(name), std::move(stage));
+  timings_.push_back({std::string(name), 0.0, 0});
+  return *this;
+}
+
+auto PreprocessPipeline::RemoveStage(std::string_view name) -> bool {
+  bool removed = false;
+  for (size_t i = stages_.size(); i-- > 0;) {
+    if (stages_[i].first == name) {
+      stages_.erase(stages_.begin() + i);
+      timings_.erase(timings_.begin() + i);
+      removed = true;
+    }
+  }
+  return removed;
+}
+
+auto PreprocessPipeline::GetStageNames() const -> std::vector<std::string> {
+  std::vector<std::string> names;
+  names.reserve(stages_.size());
+  for (const auto &[name, stage] : stages_) {
+    names.push_back(name);
+  }
+  return names;
+}
+
+auto PreprocessPipeline::Run(const cv::Mat &image) const -> cv::Mat {
+  cv::Mat current = image;
+  for (size_t i = 0; i < stages_.size(); ++i) {
+    const auto start = std::chrono::high_resolution_clock::now();
+    cv::Mat output;
+    stages_[i].second(current, output);
+    current = output;
+    const auto end = std::chrono::high_resolution_clock::now();
+
+    const std::lock_guard lock(timings_mutex_);
+    timings_[i].total_seconds_ += std::chrono::duration<double>(end - start).count();
+    ++timings_[i].calls_;
+  }
+  return current;
+}
+
+auto PreprocessPipeline::GetStageTimings() const -> std::vector<StageTiming> {
+  const std::lock_guard lock(timings_mutex_);
+  return timings_;
+}
+
+auto PreprocessPipeline::ResetStageTimings() -> void {
+  const std::lock_guard lock(timings_mutex_);
+  for (auto &timing : timings_) {
+    timing.total_seconds_ = 0.0;
+    timing.calls_ = 0;
+  }
+}
+
+auto PreprocessPipeline::Default() -> PreprocessPipeline {
+  PreprocessPipeline pipeline;
+  pipeline.AddStage("grayscale", Grayscale())
+      .AddStage("invert", Invert())
+      .AddStage("gaussian_blur", GaussianBlur())
+      .AddStage("adaptive_threshold", AdaptiveThreshold())
+      .AddStage("nl_means_denoise", NlMeansDenoise());
+  return pipeline;
+}
+
+auto PreprocessPipeline::Fast() -> PreprocessPipeline {
+  PreprocessPipeline pipeline;
+  pipeline.AddStage("grayscale", Grayscale())
+      .AddStage("invert", Invert())
+      .AddStage("gaussian_blur", GaussianBlur())
+      .AddStage("adaptive_threshold", AdaptiveThreshold())
+      .AddStage("median_blur", MedianBlur());
+  return pipeline;
+}
+
+auto PreprocessPipeline::Grayscale() -> Stage {
+  return [](const cv::Mat &input, cv::Mat &output) {
+    if (input.channels() == 3) {
+      cv::cvtColor(input, output, cv::COLOR_BGR2GRAY);
+    } else if (input.channels() == 4) {
+      cv::cvtColor(input, output, cv::COLOR_BGRA2GRAY);
+    } else {
+      input.copyTo(output);
+    }
+  };
+}
+
+auto PreprocessPipeline::Invert() -> Stage {
+  return [](const cv::Mat &input, cv::Mat &output) { cv::bitwise_not(input, output); };
+}
+
+auto PreprocessPipeline::GaussianBlur(int kernel_size) -> Stage {
+  return [kernel_size](const cv::Mat &input, cv::Mat &output) {
+    cv::GaussianBlur(input, output, cv::Size(kernel_size, kernel_size), 0);
+  };
+}
+
+auto PreprocessPipeline::AdaptiveThreshold(int block_size, double c) -> Stage {
+  return [block_size, c](const cv::Mat &input, cv::Mat &output) {
+    cv::adaptiveThreshold(input, output, 255, cv::ADAPTIVE_THRESH_GAUSSIAN_C, cv::THRESH_BINARY, block_size, c);
+  };
+}
+
+auto PreprocessPipeline::NlMeansDenoise(float h) -> Stage {
+  return [h](const cv::Mat &input, cv::Mat &output) { cv::fastNlMeansDenoising(input, output, h); };
+}
+
+auto PreprocessPipeline::MedianBlur(int kernel_size) -> Stage {
+  return [kernel_size](const cv::Mat &input, cv::Mat &output) { cv::medianBlur(input, output, kernel_size); };
+}
+
+auto PreprocessPipeline::BilateralFilter(int diameter, double sigma_color, double sigma_space) -> Stage {
+  return [diameter, sigma_color, sigma_space](const cv::Mat &input, cv::Mat &output) {
+    cv::bilateralFilter(input, output, diameter, sigma_color, sigma_space);
+  };
+}
+
+LazyPreprocessor::LazyPreprocessor(const cv::Mat &image, int tile_size, int margin)
+    : LazyPreprocessor(image, nullptr, tile_size, margin) {}
+
+LazyPreprocessor::LazyPreprocessor(const cv::Mat &image, const PreprocessPipeline &pipeline, int tile_size,
+                                   int margin)
+    : LazyPreprocessor(image, &pipeline, tile_size, margin) {}
+
+LazyPreprocessor::LazyPreprocessor(const cv::Mat &image, const PreprocessPipeline *pipeline, int tile_size,
+                                   int margin)
+    : pipeline_(pipeline),
+      image_(image),
+      processed_(image.size(), CV_8UC1, cv::Scalar::all(0)),
+      tile_size_(std::max(tile_size, 1)),
+      margin_(std::max(margin, 0)),
+      tiles_x_((image.cols + tile_size_ - 1) / tile_size_),
+      tiles_y_((image.rows + tile_size_ - 1) / tile_size_),
+      once_(std::make_unique<std::once_flag[]>(static_cast<std::size_t>(tiles_x_) * tiles_y_)),
+      processed_tiles_(0) {}
+
+auto LazyPreprocessor::Prepare(const cv::Rect &roi) -> cv::Mat {
+  const cv::Rect clipped = roi & cv::Rect(0, 0, image_.cols, image_.rows);
+  if (clipped.empty()) {
+    return {};
+  }
+
+  const int first_x = clipped.x / tile_size_;
+  const int first_y = clipped.y / tile_size_;
+  const int last_x = (clipped.x + clipped.width - 1) / tile_size_;
+  const int last_y = (clipped.y + clipped.height - 1) / tile_size_;
+  for (int ty = first_y; ty <= last_y; ++ty) {
+    for (int tx = first_x; tx <= last_x; ++tx) {
+      std::call_once(once_[static_cast<std::size_t>(ty) * tiles_x_ + tx], [this, tx, ty]() { ProcessTile(tx, ty); });
+    }
+  }
+
+  return processed_(clipped);
+}
+
+auto LazyPreprocessor::ProcessTile(int tile_x, int tile_y) -> void {
+  const cv::Rect bounds(0, 0, image_.cols, image_.rows);
+  const cv::Rect tile = cv::Rect(tile_x * tile_size_, tile_y * tile_size_, tile_size_, tile_size_) & bounds;
+  const cv::Rect region = cv::Rect(tile.x - margin_, tile.y - margin_, tile.width + 2 * margin_,
+                                   tile.height + 2 * margin_) &
+                          bounds;
+
+  const cv::Mat processed_region = pipeline_ ? pipeline_->Run(image_(region)) : Preprocess(image_(region));
+  processed_region(tile - region.tl()).copyTo(processed_(tile));
+  ++processed_tiles_;
+}
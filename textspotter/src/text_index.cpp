@@ -0,0 +1,102 @@
+#include "textspotter/text_index.hpp"
+
+#include <algorithm>
+#include <bitset>
+#include <unordered_map>
+
+#include "textspotter/utility.hpp"
+
+TextIndex::TextIndex(const std::vector<DetectReadResult> &detections) { Build(detections); }
+
+auto TextIndex::Build(const std::vector<DetectReadResult> &detections) -> void {
+  Clear();
+
+  std::unordered_map<std::string, std::size_t> positions;
+  for (std::size_t i = 0; i < detections.size(); ++i) {
+    // An empty word never matches anything.
+    if (detections[i].text_.empty()) {
+      continue;
+    }
+    auto word = ToLower(detections[i].text_);
+    const auto [it, inserted] = positions.try_emplace(word, entries_.size());
+    if (inserted) {
+      const auto signature = Signature(word);
+      entries_.push_back({std::move(word), signature, {}});
+    }
+    entries_[it->second].detections_.push_back(i);
+    ++size_;
+  }
+
+  std::stable_sort(entries_.begin(), entries_.end(),
+                   [](const Entry &lhs, const Entry &rhs) { return lhs.word_.size() < rhs.word_.size(); });
+}
+
+auto TextIndex::Clear() noexcept -> void {
+  entries_.clear();
+  size_ = 0;
+}
+
+auto TextIndex::Signature(std::string_view word) noexcept -> std::uint64_t {
+  std::uint64_t signature = 0;
+  for (const auto c : word) {
+    signature |= std::uint64_t{1} << (static_cast<unsigned char>(c) % 64);
+  }
+  return signature;
+}
+
+auto TextIndex::Find(std::string_view target) const -> std::vector<std::size_t> {
+  std::vector<std::size_t> found;
+  for (const auto &match : FindMatches(target)) {
+    found.push_back(match.detection_);
+  }
+  return found;
+}
+
+auto TextIndex::FindMatches(std::string_view target) const -> std::vector<Match> {
+  // IsMatch requires a distance below half the length of the shorter word, the lengths of the words differ by at most
+  // that much.
+  const int target_length = static_cast<int>(target.size());
+  const int max_distance = target_length / 2 - 1;
+  if (max_distance < 0) {
+    return {};
+  }
+
+  const auto shortest = std::lower_bound(
+      entries_.begin(), entries_.end(), target_length - max_distance,
+      [](const Entry &entry, int length) { return static_cast<int>(entry.word_.size()) < length; });
+  const auto longest = std::upper_bound(
+      shortest, entries_.end(), target_length + max_distance,
+      [](int length, const Entry &entry) { return length < static_cast<int>(entry.word_.size()); });
+
+  const auto lower_target = ToLower(target);
+  const auto target_signature = Signature(lower_target);
+  const LevenshteinPattern pattern(lower_target);
+
+  std::vector<Match> found;
+  for (auto it = shortest; it != longest; ++it) {
+    const int length = static_cast<int>(it->word_.size());
+    const int budget = std::min(length, target_length) / 2 - 1;
+    if (budget < 0 || std::abs(length - target_length) > budget) {
+      continue;
+    }
+    if (static_cast<int>(std::bitset<64>(target_signature & ~it->signature_).count()) > budget ||
+        static_cast<int>(std::bitset<64>(it->signature_ & ~target_signature).count()) > budget) {
+      continue;
+    }
+    const int distance = pattern.Distance(it->word_, budget);
+    if (distance <= budget) {
+      const auto similarity = 1.0F - static_cast<float>(distance) / static_cast<float>(std::max(length, target_length));
+      for (const auto detection : it->detections_) {
+        found.push_back({detection, similarity});
+      }
+    }
+  }
+
+  std::sort(found.begin(), found.end(),
+            [](const Match &lhs, const Match &rhs) { return lhs.detection_ < rhs.detection_; });
+  return found;
+}
+
+auto TextIndex::Size() const noexcept -> std::size_t { return size_; }
+
+auto TextIndex::GetNumWords() const noexcept -> std::size_t { return entries_.size(); }
@@ -1,27 +1,27 @@
 #include "textspotter/text_matching.hpp"
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
-#include <map>
+#include <future>
+#include <limits>
+#include <numeric>
+#include <unordered_map>
 #include <string>
 #include <vector>
 
+#include "textspotter/text_index.hpp"
+#include "textspotter/thread_pool.hpp"
 #include "textspotter/utility.hpp"
 
 auto IsMatch(std::string_view s1, std::string_view s2, bool case_sensitive) noexcept -> bool {
-  std::string str1(s1);
-  std::string str2(s2);
-  if (!case_sensitive) {
-    str1 = ToLower(s1);
-    str2 = ToLower(s2);
-  }
-
-  const auto min_length = std::min(str1.length(), str2.length());
-  const auto edit_dist = CalcLevenshteinDistance(str1, str2);
-  if (edit_dist > min_length) {
+  // The strings match when their distance is below half the length of the shorter one, so the comparison can stop
+  // as soon as that budget is exceeded.
+  const int max_distance = static_cast<int>(std::min(s1.length(), s2.length()) / 2) - 1;
+  if (max_distance < 0) {
     return false;
   }
-
-  return edit_dist < min_length / 2;
+  return CalcLevenshteinDistance(s1, s2, max_distance, case_sensitive) <= max_distance;
 }
 
 auto MatchWord(const std::vector<DetectReadResult> &detections, std::string_view target) noexcept -> cv::Point {
@@ -34,70 +34,314 @@ auto MatchWord(const std::vector<DetectReadResult> &detections, std::string_view
   return {-1, -1};
 }
 
-// Helper function to generate all combinations (Cartesian product)
-void GenerateCombinations(const std::map<std::string, std::vector<cv::Rect>> &mp,
-                          std::vector<std::vector<cv::Rect>> &combinations, std::vector<cv::Rect> &current,
-                          std::vector<std::string>::const_iterator iter, const std::vector<std::string> &target) {
-  if (iter == target.end()) {
-    combinations.push_back(current);
-    return;
+namespace {
+/**
+ * @brief Maximum number of candidates evaluated by one word group search, past which the best group found so far is
+ * returned.
+ */
+constexpr std::size_t kMaxSearchSteps = 1 << 20;
+
+/**
+ * @class CenterGrid
+ * @brief A uniform grid over the centers of the candidates of one word, answering radius queries.
+ */
+class CenterGrid {
+ public:
+  explicit CenterGrid(const std::vector<cv::Point> &centers) {
+    if (centers.empty()) {
+      return;
+    }
+    cv::Point min_corner = centers.front();
+    cv::Point max_corner = centers.front();
+    for (const auto &center : centers) {
+      min_corner = {std::min(min_corner.x, center.x), std::min(min_corner.y, center.y)};
+      max_corner = {std::max(max_corner.x, center.x), std::max(max_corner.y, center.y)};
+    }
+
+    // About one candidate per cell.
+    const double area = static_cast<double>(max_corner.x - min_corner.x + 1) * (max_corner.y - min_corner.y + 1);
+    cell_size_ = std::max(1, static_cast<int>(std::sqrt(area / static_cast<double>(centers.size()))));
+    origin_ = min_corner;
+    cols_ = (max_corner.x - min_corner.x) / cell_size_ + 1;
+    rows_ = (max_corner.y - min_corner.y) / cell_size_ + 1;
+    cells_.resize(static_cast<std::size_t>(cols_) * rows_);
+    for (std::size_t i = 0; i < centers.size(); ++i) {
+      const auto &center = centers[i];
+      cells_[CellIndex((center.x - origin_.x) / cell_size_, (center.y - origin_.y) / cell_size_)].push_back(i);
+    }
   }
-  for (const auto &p : mp) {
-    if (!IsMatch(p.first, *iter)) {
-      continue;
+
+  /**
+   * @brief Calls the visitor with the position of every candidate in the cells within the radius of the point.
+   *
+   * @details Candidates of the border cells may be farther than the radius, the visitor checks the exact distance.
+   */
+  template <typename Visitor>
+  auto ForEachNear(const cv::Point &point, double radius, Visitor &&visitor) const -> void {
+    if (cells_.empty()) {
+      return;
     }
-    for (const auto &candidate : p.second) {
-      current.push_back(candidate);
-      GenerateCombinations(mp, combinations, current, std::next(iter), target);
-      current.pop_back();
+    const auto cell_range = [this, radius](int coordinate, int origin, int count) {
+      const double first = std::floor((coordinate - radius - origin) / cell_size_);
+      const double last = std::floor((coordinate + radius - origin) / cell_size_);
+      return std::make_pair(static_cast<int>(std::max(first, 0.0)),
+                            static_cast<int>(std::min(last, static_cast<double>(count - 1))));
+    };
+    const auto [first_col, last_col] = cell_range(point.x, origin_.x, cols_);
+    const auto [first_row, last_row] = cell_range(point.y, origin_.y, rows_);
+    for (int row = first_row; row <= last_row; ++row) {
+      for (int col = first_col; col <= last_col; ++col) {
+        for (const auto i : cells_[CellIndex(col, row)]) {
+          visitor(i);
+        }
+      }
+    }
+  }
+
+ private:
+  auto CellIndex(int col, int row) const noexcept -> std::size_t {
+    return static_cast<std::size_t>(row) * cols_ + col;
+  }
+
+  cv::Point origin_;                             // Smallest coordinates of the centers.
+  int cell_size_ = 1;                            // Width and height of a cell.
+  int cols_ = 0;                                 // Number of columns of cells.
+  int rows_ = 0;                                 // Number of rows of cells.
+  std::vector<std::vector<std::size_t>> cells_;  // Positions of the candidates in every cell, row by row.
+};
+
+/**
+ * @class WordGroupSearch
+ * @brief Branch and bound search of the group of candidates, one per word, with the smallest sum of pairwise
+ * distances between their centers.
+ *
+ * @details Groups are built one word at a time, starting with the word having the fewest candidates. Every step only
+ * considers the candidates close enough to the first chosen one for the group to beat the best complete group, found
+ * with the grid of their word, and tries them by increasing cost, so the first complete group is the greedy one and
+ * later branches stop as soon as their cost reaches the best. Nothing proportional to the number of groups is ever
+ * stored.
+ */
+class WordGroupSearch {
+ public:
+  explicit WordGroupSearch(std::vector<std::vector<cv::Point>> centers) : order_(centers.size()) {
+    std::iota(order_.begin(), order_.end(), 0);
+    std::sort(order_.begin(), order_.end(),
+              [&centers](std::size_t lhs, std::size_t rhs) { return centers[lhs].size() < centers[rhs].size(); });
+    for (const auto word : order_) {
+      centers_.push_back(std::move(centers[word]));
+    }
+    grids_.reserve(centers_.size());
+    for (const auto &word_centers : centers_) {
+      grids_.emplace_back(word_centers);
+    }
+    chosen_.resize(centers_.size());
+    options_.resize(centers_.size());
+  }
+
+  /**
+   * @brief Runs the search.
+   *
+   * @return The position of the candidate chosen for every word, in the order of the words, empty if a word has no
+   * candidate.
+   */
+  auto Run() -> std::vector<std::size_t> {
+    if (centers_.empty() || centers_.front().empty()) {
+      return {};
+    }
+    Search(0, 0.0);
+    if (best_.empty()) {
+      return {};
+    }
+
+    std::vector<std::size_t> group(order_.size());
+    for (std::size_t i = 0; i < order_.size(); ++i) {
+      group[order_[i]] = best_[i];
+    }
+    return group;
+  }
+
+ private:
+  auto Search(std::size_t depth, double cost) -> void {
+    if (depth == centers_.size()) {
+      best_cost_ = cost;
+      best_ = chosen_;
+      return;
+    }
+
+    // Every candidate added to the group costs at least its distance to the first chosen candidate.
+    auto &options = options_[depth];
+    options.clear();
+    const auto add_option = [&](std::size_t i) {
+      const auto &candidate = centers_[depth][i];
+      double added = 0.0;
+      for (std::size_t d = 0; d < depth; ++d) {
+        added += cv::norm(centers_[d][chosen_[d]] - candidate);
+      }
+      if (cost + added < best_cost_) {
+        options.emplace_back(added, i);
+      }
+    };
+    if (depth == 0) {
+      for (std::size_t i = 0; i < centers_[0].size(); ++i) {
+        add_option(i);
+      }
+    } else {
+      grids_[depth].ForEachNear(centers_[0][chosen_[0]], best_cost_ - cost, add_option);
+    }
+    steps_ += options.size();
+    std::sort(options.begin(), options.end());
+
+    for (std::size_t k = 0; k < options.size(); ++k) {
+      const auto [added, i] = options[k];
+      if (cost + added >= best_cost_ || (steps_ > kMaxSearchSteps && !best_.empty())) {
+        return;
+      }
+      chosen_[depth] = i;
+      Search(depth + 1, cost + added);
+    }
+  }
+
+  std::vector<std::size_t> order_;                                    // Position in the target of every word.
+  std::vector<std::vector<cv::Point>> centers_;                       // Candidate centers of every word.
+  std::vector<CenterGrid> grids_;                                     // Grid over the candidates of every word.
+  std::vector<std::size_t> chosen_;                                   // Candidate chosen for every word so far.
+  std::vector<std::vector<std::pair<double, std::size_t>>> options_;  // Candidates tried at every depth.
+  std::vector<std::size_t> best_;                                     // Best complete group.
+  double best_cost_ = std::numeric_limits<double>::infinity();        // Cost of the best complete group.
+  std::size_t steps_ = 0;                                             // Number of candidates evaluated.
+};
+
+/**
+ * @brief Matches the words of a target, given the detections matching every word.
+ *
+ * @details A single word is matched by the first detection matching it, a group of words by the group of detections
+ * closest to each other.
+ */
+auto MatchCandidates(const std::vector<DetectReadResult> &detections,
+                     const std::vector<const std::vector<TextIndex::Match> *> &candidates) -> MatchResult {
+  const MatchResult not_found{{-1, -1}, 0.0F};
+  if (candidates.empty()) {
+    return not_found;
+  }
+
+  std::vector<std::vector<cv::Point>> centers;
+  centers.reserve(candidates.size());
+  for (const auto *word_matches : candidates) {
+    if (word_matches->empty()) {
+      return not_found;
+    }
+    if (candidates.size() == 1) {
+      const auto &first = word_matches->front();
+      return {GetRectCenter(detections[first.detection_].bounding_box_), first.similarity_};
+    }
+    auto &word_centers = centers.emplace_back();
+    for (const auto &match : *word_matches) {
+      word_centers.push_back(GetRectCenter(detections[match.detection_].bounding_box_));
     }
   }
-}
 
-cv::Point CalculateCenter(const std::vector<cv::Rect> &sequence) {
+  const auto group = WordGroupSearch(centers).Run();
+  if (group.empty()) {
+    return not_found;
+  }
+
   int x = 0, y = 0;
-  for (const auto &rect : sequence) {
-    x += rect.x + rect.width / 2;
-    y += rect.y + rect.height / 2;
+  float similarity = 0.0F;
+  for (std::size_t word = 0; word < group.size(); ++word) {
+    x += centers[word][group[word]].x;
+    y += centers[word][group[word]].y;
+    similarity += (*candidates[word])[group[word]].similarity_;
   }
-  x /= sequence.size();
-  y /= sequence.size();
-  return cv::Point(x, y);
+  const int size = static_cast<int>(group.size());
+  return {{x / size, y / size}, similarity / static_cast<float>(size)};
+}
+
+/**
+ * @brief Calls the body for every position in [0, count), on the workers of the thread pool if there is one.
+ */
+template <typename Body>
+auto ParallelFor(ThreadPool *thread_pool, std::size_t count, const Body &body) -> void {
+  if (thread_pool == nullptr || count < 2) {
+    for (std::size_t i = 0; i < count; ++i) {
+      body(i);
+    }
+    return;
+  }
+
+  const auto num_tasks = std::min(thread_pool->Size(), count);
+  std::vector<std::future<void>> futures;
+  futures.reserve(num_tasks);
+  for (std::size_t task = 0; task < num_tasks; ++task) {
+    futures.push_back(thread_pool->Submit([&body, task, num_tasks, count]() {
+      for (std::size_t i = task; i < count; i += num_tasks) {
+        body(i);
+      }
+    }));
+  }
+  for (auto &future : futures) {
+    future.get();
+  }
+}
+}  // namespace
+
+auto MatchWord(const std::vector<DetectReadResult> &detections, const TextIndex &index,
+               std::string_view target) noexcept -> cv::Point {
+  const auto matches = index.FindMatches(target);
+  return MatchCandidates(detections, {&matches}).point_;
 }
 
 auto MatchWordGroups(const std::vector<DetectReadResult> &detections, const std::vector<std::string> &target) noexcept
     -> cv::Point {
-  std::map<std::string, std::vector<cv::Rect>> mp;
-  for (const auto &res : detections) {
-    mp[res.text_].push_back(res.bounding_box_);
-  }
-
-  std::vector<std::vector<cv::Rect>> possible_sequences;
-  std::vector<cv::Rect> sequence;
-
-  GenerateCombinations(mp, possible_sequences, sequence, target.begin(), target);
-
-  // Find the best matching sequence
-  double minDistance = std::numeric_limits<double>::max();
-  std::vector<cv::Rect> best_sequence;
-  for (const auto &seq : possible_sequences) {
-    double distance = 0;
-    // Calculate the 'closeness' of the sequence
-    for (size_t i = 0; i < seq.size(); ++i) {
-      for (size_t j = i + 1; j < seq.size(); ++j) {
-        cv::Point center_i = cv::Point(seq[i].x + seq[i].width / 2, seq[i].y + seq[i].height / 2);
-        cv::Point center_j = cv::Point(seq[j].x + seq[j].width / 2, seq[j].y + seq[j].height / 2);
-        distance += cv::norm(center_i - center_j);
+  return MatchWordGroups(detections, TextIndex(detections), target);
+}
+
+auto MatchWordGroups(const std::vector<DetectReadResult> &detections, const TextIndex &index,
+                     const std::vector<std::string> &target) noexcept -> cv::Point {
+  std::vector<std::vector<TextIndex::Match>> matches;
+  matches.reserve(target.size());
+  for (const auto &word : target) {
+    matches.push_back(index.FindMatches(word));
+  }
+
+  std::vector<const std::vector<TextIndex::Match> *> candidates;
+  for (const auto &word_matches : matches) {
+    candidates.push_back(&word_matches);
+  }
+  return MatchCandidates(detections, candidates).point_;
+}
+
+auto MatchTarget(const std::vector<DetectReadResult> &detections, const TextIndex &index,
+                 std::string_view target) noexcept -> MatchResult {
+  return MatchTargets(detections, index, {target}).front();
+}
+
+auto MatchTargets(const std::vector<DetectReadResult> &detections, const TextIndex &index,
+                  const std::vector<std::string_view> &targets, ThreadPool *thread_pool) noexcept
+    -> std::vector<MatchResult> {
+  // Split the targets into words and look every distinct word up once, however many targets share it.
+  std::vector<std::string> words;
+  std::unordered_map<std::string, std::size_t> word_positions;
+  std::vector<std::vector<std::size_t>> target_words(targets.size());
+  for (std::size_t i = 0; i < targets.size(); ++i) {
+    for (const auto &token : SplitStr(std::string(targets[i]))) {
+      const auto [it, inserted] = word_positions.try_emplace(ToLower(token), words.size());
+      if (inserted) {
+        words.push_back(it->first);
       }
-    }
-    if (distance < minDistance) {
-      minDistance = distance;
-      best_sequence = seq;
+      target_words[i].push_back(it->second);
     }
   }
 
-  if (best_sequence.empty()) {
-    return {-1, -1};
-  }
-  return CalculateCenter(best_sequence);
+  std::vector<std::vector<TextIndex::Match>> word_matches(words.size());
+  ParallelFor(thread_pool, words.size(), [&](std::size_t i) { word_matches[i] = index.FindMatches(words[i]); });
+
+  std::vector<MatchResult> results(targets.size());
+  ParallelFor(thread_pool, targets.size(), [&](std::size_t i) {
+    std::vector<const std::vector<TextIndex::Match> *> candidates;
+    for (const auto word : target_words[i]) {
+      candidates.push_back(&word_matches[word]);
+    }
+    results[i] = MatchCandidates(detections, candidates);
+  });
+  return results;
 }
@@ -1,49 +1,315 @@
 #include "textspotter/textspotter.hpp"
 
+#include <algorithm>
 #include <opencv2/imgcodecs.hpp>
 
 #include "textspotter/detect_read.hpp"
+#include "textspotter/east_detector.hpp"
+#include "textspotter/metrics.hpp"
+#include "textspotter/ocr.hpp"
+#include "textspotter/ocr_cache.hpp"
+#include "textspotter/preprocess.hpp"
 #include "textspotter/text_matching.hpp"
+#include "textspotter/thread_pool.hpp"
 #include "textspotter/utility.hpp"
 
-TextSpotter::TextSpotter(std::string_view path, bool enable_multi_thread)
-    : model_path_(path), image_(nullptr), enable_multi_thread_(enable_multi_thread) {}
+TextSpotter::TextSpotter(std::string_view path, bool enable_multi_thread, std::size_t num_ocr_workers)
+    : enable_multi_thread_(enable_multi_thread),
+      model_path_(path),
+      image_borrowed_(false),
+      ocr_pool_(std::make_unique<TesseractPool>(num_ocr_workers)),
+      thread_pool_(enable_multi_thread ? std::make_unique<ThreadPool>(num_ocr_workers) : nullptr),
+      preprocess_pipeline_(std::make_unique<PreprocessPipeline>(PreprocessPipeline::Default())),
+      incremental_(false),
+      block_size_(32),
+      change_threshold_(4.0),
+      lazy_(false),
+      lazy_min_score_(0.8F) {}
+
+TextSpotter::~TextSpotter() = default;
+
+auto TextSpotter::LoadDetector() -> void {
+  if (detector_ == nullptr) {
+    detector_ = std::make_unique<EastTextDetector>(model_path_.c_str());
+    detector_->SetMetrics(metrics_.get());
+  }
+}
+
+auto TextSpotter::Warmup() -> void {
+  LoadDetector();
+  detector_->Warmup();
+  ocr_pool_->Warmup();
+}
+
+auto TextSpotter::SetDetector(std::unique_ptr<EastTextDetector> detector) noexcept -> void {
+  detector_ = std::move(detector);
+  if (detector_ != nullptr) {
+    detector_->SetMetrics(metrics_.get());
+  }
+}
+
+auto TextSpotter::RebuildOcrPool(std::size_t size, const RecognitionProfile &profile) -> void {
+  ocr_pool_ = std::make_unique<TesseractPool>(size, ocr_pool_->GetLanguage(), profile);
+}
+
+auto TextSpotter::SetDetectReadOptions(const DetectReadOptions &options) noexcept -> void { options_ = options; }
+
+auto TextSpotter::SetPreprocessPipeline(PreprocessPipeline pipeline) -> void {
+  preprocess_pipeline_ = std::make_unique<PreprocessPipeline>(std::move(pipeline));
+  // The tiles prepared so far were processed by the previous pipeline, which the tile cache points to.
+  lazy_tiles_ = nullptr;
+}
+
+auto TextSpotter::GetPreprocessPipeline() const noexcept -> const PreprocessPipeline & { return *preprocess_pipeline_; }
+
+auto TextSpotter::SetRecognitionProfile(const RecognitionProfile &profile) -> void {
+  RebuildOcrPool(ocr_pool_->Size(), profile);
+}
+
+auto TextSpotter::GetRecognitionProfile() const noexcept -> const RecognitionProfile & {
+  return ocr_pool_->GetRecognitionProfile();
+}
+
+auto TextSpotter::SetThreadingConfig(const ThreadingConfig &config) -> void {
+  threading_ = config.Resolve();
+  ApplyThreadingConfig(*threading_);
+  RebuildOcrPool(threading_->ocr_threads_, ocr_pool_->GetRecognitionProfile());
+  if (enable_multi_thread_) {
+    // Let the previous workers finish before starting the new ones, so that the budget is never exceeded.
+    thread_pool_ = nullptr;
+    thread_pool_ = std::make_unique<ThreadPool>(threading_->ocr_threads_, threading_->GetOcrCores(),
+                                                threading_->ocr_engine_threads_);
+  }
+}
+
+auto TextSpotter::GetThreadingConfig() const noexcept -> const std::optional<ThreadingConfig> & { return threading_; }
+
+auto TextSpotter::EnableOcrCache(std::size_t capacity_bytes) -> OcrCache & {
+  ocr_cache_ = std::make_unique<OcrCache>(capacity_bytes);
+  return *ocr_cache_;
+}
+
+auto TextSpotter::DisableOcrCache() noexcept -> void { ocr_cache_ = nullptr; }
+
+auto TextSpotter::GetOcrCache() const noexcept -> OcrCache * { return ocr_cache_.get(); }
+
+auto TextSpotter::EnableMetrics() -> Metrics & {
+  metrics_ = std::make_unique<Metrics>();
+  if (detector_ != nullptr) {
+    detector_->SetMetrics(metrics_.get());
+  }
+  return *metrics_;
+}
+
+auto TextSpotter::DisableMetrics() noexcept -> void {
+  if (detector_ != nullptr) {
+    detector_->SetMetrics(nullptr);
+  }
+  metrics_ = nullptr;
+}
+
+auto TextSpotter::GetMetrics() const noexcept -> Metrics * { return metrics_.get(); }
+
+auto TextSpotter::SetIncremental(bool enable, int block_size, double threshold) noexcept -> void {
+  incremental_ = enable;
+  block_size_ = block_size;
+  change_threshold_ = threshold;
+  previous_image_ = cv::Mat();
+}
+
+auto TextSpotter::SetLazyRecognition(bool enable, float min_score) noexcept -> void {
+  if (enable != lazy_) {
+    // The results of either mode are meaningless to the other: lazy results only hold the regions read so far, which
+    // the incremental mode would take for the complete results of the previous image.
+    previous_image_ = cv::Mat();
+    det_results_.clear();
+    text_index_.Clear();
+  }
+  lazy_ = enable;
+  lazy_min_score_ = min_score;
+  ResetLazyState();
+  lazy_recognizer_.ClearLastHit();
+}
+
+auto TextSpotter::ResetLazyState() noexcept -> void {
+  lazy_recognizer_.Reset();
+  lazy_tiles_ = nullptr;
+}
 
 auto TextSpotter::LoadImage(std::string_view path) noexcept -> void {
-  const auto image = cv::imread(path.data(), cv::IMREAD_COLOR);
-  image_ = image.empty() ? nullptr : std::make_unique<cv::Mat>(image);
+  const StageTimer timer(metrics_.get(), kStageLoad);
+  image_ = cv::imread(path.data(), cv::IMREAD_COLOR);
+  image_borrowed_ = false;
+  ResetLazyState();
 }
 
 auto TextSpotter::LoadImage(const cv::Mat &image) noexcept -> void {
-  image_ = image.empty() ? nullptr : std::make_unique<cv::Mat>(image.clone());
+  const StageTimer timer(metrics_.get(), kStageLoad);
+  image_ = image.clone();
+  image_borrowed_ = false;
+  ResetLazyState();
 }
 
-auto TextSpotter::GetImage() const noexcept -> cv::Mat { return image_ == nullptr ? cv::Mat() : image_->clone(); }
+auto TextSpotter::LoadImageView(const cv::Mat &image) noexcept -> void {
+  image_ = image;
+  image_borrowed_ = true;
+  ResetLazyState();
+}
 
-auto TextSpotter::DetectRead() noexcept -> std::vector<DetectReadResult> {
-  if (image_ == nullptr) {
-    return {};
-  }
-  if (enable_multi_thread_) {
-    det_results_ = std::move(DetectReadTextMultiThread(*image_, model_path_, false));
+auto TextSpotter::LoadImageView(const void *data, int width, int height, int type, std::size_t step) noexcept
+    -> void {
+  if (data == nullptr || width <= 0 || height <= 0) {
+    image_ = cv::Mat();
   } else {
-    det_results_ = std::move(DetectReadText(*image_, model_path_, false));
+    // The pixels are only read, the const is dropped to build the header. A step of 0 is cv::Mat::AUTO_STEP.
+    image_ = cv::Mat(height, width, type, const_cast<void *>(data), step);
+  }
+  image_borrowed_ = true;
+  ResetLazyState();
+}
+
+auto TextSpotter::GetImage() const noexcept -> const cv::Mat & { return image_; }
+
+auto TextSpotter::DetectRead() noexcept -> const std::vector<DetectReadResult> & {
+  ResetLazyState();
+  if (image_.empty()) {
+    det_results_.clear();
+    text_index_.Clear();
+    return det_results_;
+  }
+  LoadDetector();
+  const StageTimer timer(metrics_.get(), kStageDetectRead);
+  if (metrics_ != nullptr) {
+    metrics_->Increment(kCounterImages);
+  }
+
+  if (lazy_) {
+    // The regions are recognized by the queries.
+    lazy_recognizer_.Reset(DetectTextRegions(image_, *detector_, GetPipelineOptions()));
+    det_results_.clear();
+    text_index_.Clear();
+    return det_results_;
+  }
+  if (!incremental_ || previous_image_.empty() || !DetectReadChanged()) {
+    det_results_ = DetectReadImage(image_);
   }
+  if (incremental_) {
+    // An owned image is never modified in place, sharing its pixels is enough. A borrowed buffer is typically reused
+    // by the caller for the next frame, so it must be copied to be compared with it.
+    previous_image_ = image_borrowed_ ? image_.clone() : image_;
+  }
+  text_index_.Build(det_results_);
   return det_results_;
 }
 
+auto TextSpotter::GetPipelineOptions() const noexcept -> DetectReadOptions {
+  auto options = options_;
+  options.preprocess_pipeline_ = preprocess_pipeline_.get();
+  if (ocr_cache_ != nullptr) {
+    options.ocr_cache_ = ocr_cache_.get();
+  }
+  if (metrics_ != nullptr) {
+    options.metrics_ = metrics_.get();
+  }
+  if (threading_ && options.omp_num_threads_ == 0) {
+    options.omp_num_threads_ = static_cast<int>(threading_->ocr_threads_);
+  }
+  return options;
+}
+
+auto TextSpotter::DetectReadImage(const cv::Mat &image) noexcept -> std::vector<DetectReadResult> {
+  const auto options = GetPipelineOptions();
+  if (enable_multi_thread_) {
+    return DetectReadTextMultiThread(image, *detector_, *ocr_pool_, *thread_pool_, false, options);
+  }
+  return DetectReadText(image, *detector_, *ocr_pool_, false, options);
+}
+
+auto TextSpotter::DetectReadChanged() noexcept -> bool {
+  auto regions = FindChangedRegions(previous_image_, image_, block_size_, change_threshold_);
+  if (regions.empty()) {
+    return true;
+  }
+
+  const cv::Rect bounds(0, 0, image_.cols, image_.rows);
+  // Grow the regions by one block, so that text on their border is read in full, and by the previous results they
+  // touch, which are read again.
+  std::vector<cv::Rect> boxes;
+  boxes.reserve(det_results_.size());
+  for (const auto &res : det_results_) {
+    boxes.push_back(res.bounding_box_);
+  }
+  regions = GrowChangedRegions(std::move(regions), boxes, block_size_, bounds);
+
+  int changed_area = 0;
+  for (const auto &region : regions) {
+    changed_area += region.area();
+  }
+  if (changed_area * 2 > bounds.area()) {
+    return false;
+  }
+
+  std::vector<DetectReadResult> results;
+  for (const auto &res : det_results_) {
+    const bool unchanged = std::none_of(regions.begin(), regions.end(), [&res](const cv::Rect &region) {
+      return (res.bounding_box_ & region).area() > 0;
+    });
+    if (unchanged) {
+      results.push_back(res);
+    }
+  }
+
+  for (const auto &region : regions) {
+    for (auto res : DetectReadImage(image_(region))) {
+      res.bounding_box_ += region.tl();
+      results.push_back(std::move(res));
+    }
+  }
+
+  det_results_ = std::move(results);
+  return true;
+}
+
+auto TextSpotter::ReadLazyRegions(const std::vector<TextDetectionResult> &regions) const noexcept
+    -> std::vector<DetectReadResult> {
+  auto options = GetPipelineOptions();
+  // Only the pixels around the regions read are preprocessed, the tiles are shared by the queries on the image.
+  if (lazy_tiles_ == nullptr) {
+    lazy_tiles_ = std::make_unique<LazyPreprocessor>(image_, *preprocess_pipeline_);
+  }
+  options.preprocess_mode_ = PreprocessMode::kLazy;
+  options.lazy_preprocessor_ = lazy_tiles_.get();
+  // The regions are already merged.
+  options.merge_boxes_ = false;
+  return ReadDetectedText(image_, regions, *ocr_pool_, thread_pool_.get(), options);
+}
+
 auto TextSpotter::MatchText(std::string_view target) const noexcept -> cv::Point {
-  if (image_ == nullptr) {
+  if (image_.empty()) {
     return {-1, -1};
   }
-
-  cv::Point pt;
-  const auto tokens = SplitStr(std::string(target));
-  if (tokens.size() == 1) {
-    pt = MatchWord(det_results_, tokens[0]);
-  } else {
-    pt = MatchWordGroups(det_results_, tokens);
+  const StageTimer timer(metrics_.get(), kStageMatch);
+  if (lazy_) {
+    const std::lock_guard lock(lazy_mutex_);
+    // Read as many regions at once as there are workers, so that a batch takes about as long as a single region.
+    const std::size_t batch_size = thread_pool_ != nullptr ? thread_pool_->Size() : 1;
+    return lazy_recognizer_
+        .Match(target, image_.size(), batch_size, lazy_min_score_,
+               [this](const auto &regions) { return ReadLazyRegions(regions); })
+        .point_;
   }
+  return MatchTarget(det_results_, text_index_, target).point_;
+}
 
-  return pt;
+auto TextSpotter::MatchTexts(const std::vector<std::string_view> &targets) const noexcept -> std::vector<MatchResult> {
+  if (image_.empty()) {
+    return std::vector<MatchResult>(targets.size(), {{-1, -1}, 0.0F});
+  }
+  const StageTimer timer(metrics_.get(), kStageMatch);
+  if (lazy_) {
+    const std::lock_guard lock(lazy_mutex_);
+    lazy_recognizer_.ReadAll([this](const auto &regions) { return ReadLazyRegions(regions); });
+    return MatchTargets(lazy_recognizer_.GetResults(), lazy_recognizer_.GetIndex(), targets, thread_pool_.get());
+  }
+  return MatchTargets(det_results_, text_index_, targets, thread_pool_.get());
 }
@@ -0,0 +1,205 @@
+#include "textspotter/textspotter_stream.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <opencv2/imgproc.hpp>
+#include <opencv2/videoio.hpp>
+#include <stdexcept>
+
+#include "textspotter/east_detector.hpp"
+#include "textspotter/ocr.hpp"
+#include "textspotter/text_index.hpp"
+#include "textspotter/text_matching.hpp"
+#include "textspotter/thread_pool.hpp"
+
+TextSpotterStream::TextSpotterStream(std::string_view model_path, std::size_t num_ocr_workers,
+                                     std::size_t queue_capacity, bool drop_frames)
+    : model_path_(model_path),
+      queue_capacity_(queue_capacity),
+      drop_frames_(drop_frames),
+      ocr_pool_(std::make_unique<TesseractPool>(num_ocr_workers)),
+      thread_pool_(std::make_unique<ThreadPool>(num_ocr_workers)),
+      stop_(false) {}
+
+TextSpotterStream::~TextSpotterStream() { Stop(); }
+
+auto TextSpotterStream::SetDetectReadOptions(const DetectReadOptions &options) -> void { options_ = options; }
+
+auto TextSpotterStream::SetTargets(std::vector<std::string> targets) -> void { targets_ = std::move(targets); }
+
+auto TextSpotterStream::SetDetectStage(DetectStage detect) -> void { detect_ = std::move(detect); }
+
+auto TextSpotterStream::SetReadStage(ReadStage read) -> void { read_ = std::move(read); }
+
+auto TextSpotterStream::Start(FrameSource source, ResultCallback callback) -> void {
+  Stop();
+
+  // The stages run on their own copy of the settings, which may change while they run.
+  DetectStage detect = detect_;
+  if (!detect) {
+    if (detector_ == nullptr) {
+      detector_ = std::make_unique<EastTextDetector>(model_path_.c_str());
+      detector_->Warmup();
+    }
+    detect = [detector = detector_.get(), options = options_](const cv::Mat &frame) {
+      return options.tiled_detection_ ? detector->detectTiled(frame, options.tile_overlap_) : detector->detect(frame);
+    };
+  }
+  ReadStage read = read_;
+  if (!read) {
+    ocr_pool_->Warmup();
+    read = [this, options = options_](const cv::Mat &frame, const std::vector<TextDetectionResult> &regions) {
+      return ReadDetectedText(frame, regions, *ocr_pool_, thread_pool_.get(), options);
+    };
+  }
+
+  {
+    const std::lock_guard lock(stats_mutex_);
+    stats_.assign(kNumStages, StreamStageStats{});
+    const char *names[kNumStages] = {"capture", "detect", "read", "match", "end_to_end"};
+    for (std::size_t i = 0; i < kNumStages; ++i) {
+      stats_[i].name_ = names[i];
+    }
+  }
+
+  stop_ = false;
+  detect_queue_ = std::make_unique<BoundedQueue<Frame>>(queue_capacity_);
+  read_queue_ = std::make_unique<BoundedQueue<Frame>>(queue_capacity_);
+  match_queue_ = std::make_unique<BoundedQueue<Frame>>(queue_capacity_);
+
+  threads_.emplace_back(&TextSpotterStream::CaptureLoop, this, std::move(source));
+  threads_.emplace_back(&TextSpotterStream::DetectLoop, this, std::move(detect));
+  threads_.emplace_back(&TextSpotterStream::ReadLoop, this, std::move(read));
+  threads_.emplace_back(&TextSpotterStream::MatchLoop, this, std::move(callback), targets_);
+}
+
+auto TextSpotterStream::Wait() -> void { Join(); }
+
+auto TextSpotterStream::Stop() -> void {
+  if (threads_.empty()) {
+    return;
+  }
+  stop_ = true;
+  detect_queue_->Cancel();
+  read_queue_->Cancel();
+  match_queue_->Cancel();
+  Join();
+}
+
+auto TextSpotterStream::Join() -> void {
+  for (auto &thread : threads_) {
+    thread.join();
+  }
+  threads_.clear();
+}
+
+auto TextSpotterStream::GetStageStats() const -> std::vector<StreamStageStats> {
+  const std::lock_guard lock(stats_mutex_);
+  return stats_;
+}
+
+auto TextSpotterStream::Forward(BoundedQueue<Frame> &queue, Frame frame, Stage stage) -> void {
+  if (!drop_frames_) {
+    queue.Push(std::move(frame));
+    return;
+  }
+  if (queue.PushOrDrop(std::move(frame)) && !stop_) {
+    const std::lock_guard lock(stats_mutex_);
+    ++stats_[stage].dropped_;
+  }
+}
+
+auto TextSpotterStream::Record(Stage stage, Clock::time_point start) -> void {
+  const auto seconds = std::chrono::duration<double>(Clock::now() - start).count();
+  const std::lock_guard lock(stats_mutex_);
+  auto &stats = stats_[stage];
+  ++stats.frames_;
+  stats.total_seconds_ += seconds;
+  stats.max_seconds_ = std::max(stats.max_seconds_, seconds);
+}
+
+auto TextSpotterStream::CaptureLoop(FrameSource source) -> void {
+  for (std::size_t index = 0; !stop_; ++index) {
+    const auto start = Clock::now();
+    Frame frame{index, start, cv::Mat(), {}, {}};
+    if (!source(frame.image_) || frame.image_.empty()) {
+      break;
+    }
+    Record(kCapture, start);
+    Forward(*detect_queue_, std::move(frame), kCapture);
+  }
+  detect_queue_->Close();
+}
+
+auto TextSpotterStream::DetectLoop(DetectStage detect) -> void {
+  while (auto frame = detect_queue_->Pop()) {
+    const auto start = Clock::now();
+    frame->detections_ = detect(frame->image_);
+    Record(kDetect, start);
+    Forward(*read_queue_, std::move(*frame), kDetect);
+  }
+  read_queue_->Close();
+}
+
+auto TextSpotterStream::ReadLoop(ReadStage read) -> void {
+  while (auto frame = read_queue_->Pop()) {
+    const auto start = Clock::now();
+    frame->results_ = read(frame->image_, frame->detections_);
+    Record(kRead, start);
+    Forward(*match_queue_, std::move(*frame), kRead);
+  }
+  match_queue_->Close();
+}
+
+auto TextSpotterStream::MatchLoop(ResultCallback callback, std::vector<std::string> target_texts) -> void {
+  const std::vector<std::string_view> targets(target_texts.begin(), target_texts.end());
+  while (auto frame = match_queue_->Pop()) {
+    const auto start = Clock::now();
+    StreamFrameResult result{frame->index_, std::move(frame->results_), {}, 0.0};
+    if (!targets.empty()) {
+      const TextIndex index(result.detections_);
+      result.matches_ = MatchTargets(result.detections_, index, targets, thread_pool_.get());
+    }
+    Record(kMatch, start);
+
+    result.latency_seconds_ = std::chrono::duration<double>(Clock::now() - frame->captured_).count();
+    Record(kEndToEnd, frame->captured_);
+    if (callback) {
+      callback(result);
+    }
+  }
+}
+
+auto TextSpotterStream::OpenVideo(std::string_view source) -> FrameSource {
+  auto capture = std::make_shared<cv::VideoCapture>();
+  const bool is_device = !source.empty() && std::all_of(source.begin(), source.end(), [](char c) {
+    return std::isdigit(static_cast<unsigned char>(c)) != 0;
+  });
+  if (is_device) {
+    capture->open(std::stoi(std::string(source)));
+  } else {
+    capture->open(std::string(source));
+  }
+  if (!capture->isOpened()) {
+    throw std::runtime_error("Could not open video source " + std::string(source));
+  }
+  return [capture](cv::Mat &frame) { return capture->read(frame); };
+}
+
+auto TextSpotterStream::SyntheticVideo(int num_frames, cv::Size size) -> FrameSource {
+  return [num_frames, size, index = 0](cv::Mat &frame) mutable {
+    if (index >= num_frames) {
+      return false;
+    }
+    frame = cv::Mat(size, CV_8UC3, cv::Scalar(255, 255, 255));
+    const std::string lines[] = {"Settings", "Cancel", "Apply changes", "Frame " + std::to_string(index)};
+    for (int i = 0; i < 4; ++i) {
+      // Every line scrolls horizontally at its own speed.
+      const int x = 20 + (index * (i + 1) * 7) % std::max(size.width / 2, 1);
+      const int y = (i + 1) * size.height / 5;
+      cv::putText(frame, lines[i], {x, y}, cv::FONT_HERSHEY_SIMPLEX, 1.5, cv::Scalar(0, 0, 0), 3);
+    }
+    ++index;
+    return true;
+  };
+}
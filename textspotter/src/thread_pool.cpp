@@ -0,0 +1,139 @@
+#include "textspotter/thread_pool.hpp"
+
+#include <algorithm>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "textspotter/threading.hpp"
+
+namespace {
+thread_local const ThreadPool *current_pool = nullptr;
+thread_local std::size_t current_index = 0;
+}  // namespace
+
+ThreadPool::ThreadPool(std::size_t num_workers, std::vector<int> cores, std::size_t engine_threads)
+    : cores_(std::move(cores)), engine_threads_(engine_threads), pending_(0), next_(0), stop_(false) {
+  const std::size_t size = num_workers == 0 ? std::max(1U, std::thread::hardware_concurrency()) : num_workers;
+  workers_.reserve(size);
+  for (std::size_t i = 0; i < size; ++i) {
+    workers_.push_back(std::make_unique<Worker>());
+  }
+  threads_.reserve(size);
+  for (std::size_t i = 0; i < size; ++i) {
+    threads_.emplace_back([this, i]() { Run(i); });
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    const std::lock_guard lock(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  for (auto &thread : threads_) {
+    thread.join();
+  }
+}
+
+auto ThreadPool::CurrentWorkerIndex() const noexcept -> std::optional<std::size_t> {
+  if (current_pool != this) {
+    return std::nullopt;
+  }
+  return current_index;
+}
+
+auto ThreadPool::Global() -> ThreadPool & {
+  static ThreadPool pool;
+  return pool;
+}
+
+auto ThreadPool::Push(std::function<void()> task) -> void {
+  std::size_t index;
+  if (const auto worker_index = CurrentWorkerIndex()) {
+    index = *worker_index;
+  } else {
+    const std::lock_guard lock(mutex_);
+    index = next_;
+    next_ = (next_ + 1) % workers_.size();
+  }
+
+  // Count the task before it becomes visible, so that a worker never takes a task that is not counted yet.
+  {
+    const std::lock_guard lock(mutex_);
+    ++pending_;
+  }
+  {
+    const std::lock_guard lock(workers_[index]->mutex_);
+    workers_[index]->tasks_.push_back(std::move(task));
+  }
+  cv_.notify_one();
+}
+
+auto ThreadPool::TryPop(std::size_t index, std::function<void()> &task) -> bool {
+  auto &worker = *workers_[index];
+  const std::lock_guard lock(worker.mutex_);
+  if (worker.tasks_.empty()) {
+    return false;
+  }
+  task = std::move(worker.tasks_.back());
+  worker.tasks_.pop_back();
+  return true;
+}
+
+auto ThreadPool::TrySteal(std::size_t index, std::function<void()> &task) -> bool {
+  for (std::size_t offset = 1; offset < workers_.size(); ++offset) {
+    auto &victim = *workers_[(index + offset) % workers_.size()];
+    const std::lock_guard lock(victim.mutex_);
+    if (!victim.tasks_.empty()) {
+      task = std::move(victim.tasks_.front());
+      victim.tasks_.pop_front();
+      return true;
+    }
+  }
+  return false;
+}
+
+auto ThreadPool::Run(std::size_t index) -> void {
+  current_pool = this;
+  current_index = index;
+#ifdef __linux__
+  if (!cores_.empty()) {
+    const int core = cores_[index % cores_.size()];
+    if (core >= 0 && core < CPU_SETSIZE) {
+      cpu_set_t cpu_set;
+      CPU_ZERO(&cpu_set);
+      CPU_SET(core, &cpu_set);
+      // Fails for a core the process may not run on, the worker then stays where it is.
+      pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+    }
+  }
+#endif
+  if (engine_threads_ > 0) {
+    LimitEngineThreads(engine_threads_);
+  }
+
+  std::function<void()> task;
+  while (true) {
+    {
+      std::unique_lock lock(mutex_);
+      cv_.wait(lock, [this] { return stop_ || pending_ > 0; });
+      if (stop_ && pending_ == 0) {
+        return;
+      }
+    }
+
+    if (TryPop(index, task) || TrySteal(index, task)) {
+      {
+        const std::lock_guard lock(mutex_);
+        --pending_;
+      }
+      task();
+      task = nullptr;
+    } else {
+      // The task is counted but not pushed yet, or another worker took it first.
+      std::this_thread::yield();
+    }
+  }
+}
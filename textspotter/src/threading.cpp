@@ -0,0 +1,57 @@
+#include "textspotter/threading.hpp"
+
+#include <algorithm>
+#include <opencv2/core.hpp>
+#include <thread>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+auto ThreadingConfig::Resolve() const noexcept -> ThreadingConfig {
+  auto resolved = *this;
+  if (resolved.total_threads_ == 0) {
+    resolved.total_threads_ = std::max(1U, std::thread::hardware_concurrency());
+  }
+  const auto total = resolved.total_threads_;
+  if (resolved.opencv_threads_ == 0 && resolved.ocr_threads_ == 0) {
+    // Recognition takes most of the time of an image, one region per engine and per worker.
+    resolved.opencv_threads_ = std::max<std::size_t>(total / 4, 1);
+  } else if (resolved.opencv_threads_ == 0) {
+    resolved.opencv_threads_ = total > resolved.ocr_threads_ ? total - resolved.ocr_threads_ : 1;
+  }
+  if (resolved.ocr_threads_ == 0) {
+    resolved.ocr_threads_ = total > resolved.opencv_threads_ ? total - resolved.opencv_threads_ : 1;
+  }
+  resolved.ocr_engine_threads_ = std::max<std::size_t>(resolved.ocr_engine_threads_, 1);
+  return resolved;
+}
+
+auto ThreadingConfig::GetOcrCores() const -> std::vector<int> {
+  if (!pin_threads_) {
+    return {};
+  }
+  const auto resolved = Resolve();
+  std::vector<int> cores;
+  cores.reserve(resolved.ocr_threads_);
+  for (std::size_t i = 0; i < resolved.ocr_threads_; ++i) {
+    cores.push_back(first_core_ + static_cast<int>(resolved.opencv_threads_ + i));
+  }
+  return cores;
+}
+
+auto ApplyThreadingConfig(const ThreadingConfig &config) -> void {
+  const auto resolved = config.Resolve();
+  cv::setNumThreads(static_cast<int>(resolved.opencv_threads_));
+#ifdef _OPENMP
+  // The loops of Tesseract run inside the recognition loop, a single active level keeps them on the calling thread.
+  omp_set_max_active_levels(1);
+#endif
+}
+
+auto LimitEngineThreads(std::size_t num_threads) noexcept -> void {
+#ifdef _OPENMP
+  omp_set_num_threads(static_cast<int>(std::max<std::size_t>(num_threads, 1)));
+#else
+  static_cast<void>(num_threads);
+#endif
+}
@@ -0,0 +1,28 @@
+#include "textspotter/tiling.hpp"
+
+#include <algorithm>
+
+auto TileOrigins(int length, int tile, int overlap) -> std::vector<int> {
+  const int step = std::max(tile - overlap, 1);
+  std::vector<int> origins;
+  for (int origin = 0; origin + tile < length; origin += step) {
+    origins.push_back(origin);
+  }
+  origins.push_back(std::max(length - tile, 0));
+  return origins;
+}
+
+auto IsHeldByNeighbour(const cv::Rect &box, const cv::Rect &tile, const cv::Size &image_size, int overlap) -> bool {
+  // Distance in pixels under which a box touches a border.
+  constexpr int margin = 2;
+  const bool cut_left = tile.x > 0 && box.x <= margin;
+  const bool cut_top = tile.y > 0 && box.y <= margin;
+  const bool cut_right = tile.x + tile.width < image_size.width && box.x + box.width >= tile.width - margin;
+  const bool cut_bottom = tile.y + tile.height < image_size.height && box.y + box.height >= tile.height - margin;
+  // The neighbour holds the box whole if it lies within the shared band, clear of the border of the neighbour. Twice
+  // the margin leaves room for the boxes of the two tiles to differ by a pixel or two.
+  return (cut_left && box.x + box.width < overlap - 2 * margin) ||
+         (cut_top && box.y + box.height < overlap - 2 * margin) ||
+         (cut_right && box.x > tile.width - overlap + 2 * margin) ||
+         (cut_bottom && box.y > tile.height - overlap + 2 * margin);
+}
@@ -1,9 +1,17 @@
 #include "textspotter/utility.hpp"
 
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
+#include <cstdint>
 #include <opencv2/highgui.hpp>
 #include <opencv2/imgcodecs.hpp>
 #include <opencv2/imgproc.hpp>
-#include <opencv2/photo.hpp>
+
+#include "textspotter/preprocess.hpp"
 
 ScopedTimer::ScopedTimer(std::string_view name) : name_(name), start_(std::chrono::high_resolution_clock::now()) {}
 
@@ -19,13 +27,15 @@ auto Timer::Start() noexcept -> void { start_ = std::chrono::high_resolution_clo
 
 auto Timer::End() noexcept -> void { end_ = std::chrono::high_resolution_clock::now(); }
 
-auto Timer::GetElapsedSeconds() const noexcept -> int {
+auto Timer::GetElapsedSeconds() const noexcept -> double {
   return std::chrono::duration_cast<std::chrono::duration<double>>(end_ - start_).count();
 }
 
-auto LoadImage(const char *image_path) -> cv::Mat { return LoadImage(std::string_view(image_path)); }
+auto LoadImage(const char *image_path, const cv::Size &size) -> cv::Mat {
+  return LoadImage(std::string_view(image_path), size);
+}
 
-auto LoadImage(std::string_view image_path) -> cv::Mat {
+auto LoadImage(std::string_view image_path, const cv::Size &size) -> cv::Mat {
   if (image_path.empty()) {
     throw std::invalid_argument("image path cannot be empty");
   }
@@ -35,68 +45,352 @@ auto LoadImage(std::string_view image_path) -> cv::Mat {
     throw std::invalid_argument("image at path " + std::string(image_path) + "is empty");
   }
 
-  cv::resize(image, image, cv::Size(1280, 720));
+  if (!size.empty() && size != image.size()) {
+    cv::resize(image, image, size);
+  }
 
   return image;
 }
 
 auto Preprocess(const cv::Mat &image) noexcept -> cv::Mat {
-  cv::Mat processed_image;
-  if (image.channels() == 3) {
-    cv::cvtColor(image, processed_image, cv::COLOR_BGR2GRAY);
-  } else if (image.channels() == 4) {
-    cv::cvtColor(image, processed_image, cv::COLOR_BGRA2GRAY);
-  } else {
-    processed_image = image;
+  // The stages of PreprocessPipeline::Default(), run without timing so that concurrent calls share no state.
+  static const PreprocessPipeline::Stage stages[] = {
+      PreprocessPipeline::Grayscale(), PreprocessPipeline::Invert(), PreprocessPipeline::GaussianBlur(),
+      PreprocessPipeline::AdaptiveThreshold(), PreprocessPipeline::NlMeansDenoise()};
+  cv::Mat current = image;
+  for (const auto &stage : stages) {
+    cv::Mat output;
+    stage(current, output);
+    current = output;
   }
+  return current;
+}
 
-  cv::bitwise_not(processed_image, processed_image);
+auto RectifyRegion(const cv::Mat &image, const cv::RotatedRect &box, int padding, cv::Mat &crop_to_image) noexcept
+    -> cv::Mat {
+  const cv::Size2f padded_size(box.size.width + 2.0F * padding, box.size.height + 2.0F * padding);
+  const cv::RotatedRect padded(box.center, padded_size, box.angle);
+  const cv::Size crop_size(cvRound(padded.size.width), cvRound(padded.size.height));
+  if (image.empty() || crop_size.width <= 0 || crop_size.height <= 0) {
+    return {};
+  }
 
-  cv::GaussianBlur(processed_image, processed_image, cv::Size(5, 5), 0);
+  // Vertices are ordered bottom left, top left, top right, bottom right in the frame of the box.
+  cv::Point2f vertices[4];
+  padded.points(vertices);
+  const cv::Point2f src[3] = {vertices[1], vertices[2], vertices[3]};
+  const cv::Point2f dst[3] = {{0.0F, 0.0F},
+                              {static_cast<float>(crop_size.width), 0.0F},
+                              {static_cast<float>(crop_size.width), static_cast<float>(crop_size.height)}};
 
-  cv::adaptiveThreshold(processed_image, processed_image, 255, cv::ADAPTIVE_THRESH_GAUSSIAN_C, cv::THRESH_BINARY, 5, 3);
+  const cv::Mat image_to_crop = cv::getAffineTransform(src, dst);
+  cv::invertAffineTransform(image_to_crop, crop_to_image);
 
-  cv::fastNlMeansDenoising(processed_image, processed_image);
+  cv::Mat crop;
+  cv::warpAffine(image, crop, image_to_crop, crop_size, cv::INTER_LINEAR, cv::BORDER_REPLICATE);
+  return crop;
+}
 
-  // cv::imshow("processed", processed_image);
-  // cv::waitKey();
-  // cv::destroyWindow("processed");
-  return processed_image;
+auto MapCropToImage(const cv::Rect &box, const cv::Mat &crop_to_image, const cv::Size &image_size) noexcept
+    -> cv::Rect {
+  const std::vector<cv::Point2f> corners{box.tl(), {static_cast<float>(box.x + box.width), static_cast<float>(box.y)},
+                                         box.br(), {static_cast<float>(box.x), static_cast<float>(box.y + box.height)}};
+  std::vector<cv::Point2f> mapped;
+  cv::transform(corners, mapped, crop_to_image);
+
+  // The corners bound the pixels, so the box ends at the furthest corner rather than one pixel past it. The tolerance
+  // absorbs the rounding of the transform.
+  constexpr float tolerance = 1e-3F;
+  float min_x = mapped[0].x, min_y = mapped[0].y, max_x = mapped[0].x, max_y = mapped[0].y;
+  for (const auto &point : mapped) {
+    min_x = std::min(min_x, point.x);
+    min_y = std::min(min_y, point.y);
+    max_x = std::max(max_x, point.x);
+    max_y = std::max(max_y, point.y);
+  }
+  const cv::Rect image_box(cv::Point(cvFloor(min_x + tolerance), cvFloor(min_y + tolerance)),
+                           cv::Point(cvCeil(max_x - tolerance), cvCeil(max_y - tolerance)));
+  return image_box & cv::Rect(cv::Point(0, 0), image_size);
 }
 
-auto CalcLevenshteinDistance(std::string_view s1, std::string_view s2) noexcept -> int {
-  if (s1.empty()) {
-    return s2.size();
+auto FoldAngle(float angle) noexcept -> float {
+  angle = std::fmod(angle, 180.0F);
+  if (angle > 90.0F) {
+    angle -= 180.0F;
+  } else if (angle < -90.0F) {
+    angle += 180.0F;
   }
+  return angle;
+}
 
-  if (s2.empty()) {
-    return s1.size();
+auto FindChangedRegions(const cv::Mat &previous, const cv::Mat &current, int block_size, double threshold) noexcept
+    -> std::vector<cv::Rect> {
+  if (current.empty()) {
+    return {};
+  }
+  const cv::Rect bounds(0, 0, current.cols, current.rows);
+  if (previous.size() != current.size() || previous.type() != current.type()) {
+    return {bounds};
+  }
+
+  cv::Mat diff;
+  cv::absdiff(previous, current, diff);
+  if (diff.channels() == 3) {
+    cv::cvtColor(diff, diff, cv::COLOR_BGR2GRAY);
+  } else if (diff.channels() == 4) {
+    cv::cvtColor(diff, diff, cv::COLOR_BGRA2GRAY);
   }
 
-  int l1 = s1.size();
-  int l2 = s2.size();
+  block_size = std::max(block_size, 1);
+  const int blocks_x = (current.cols + block_size - 1) / block_size;
+  const int blocks_y = (current.rows + block_size - 1) / block_size;
+  cv::Mat changed(blocks_y, blocks_x, CV_8UC1, cv::Scalar::all(0));
+  for (int by = 0; by < blocks_y; ++by) {
+    for (int bx = 0; bx < blocks_x; ++bx) {
+      const cv::Rect block = cv::Rect(bx * block_size, by * block_size, block_size, block_size) & bounds;
+      if (cv::mean(diff(block))[0] > threshold) {
+        changed.at<uchar>(by, bx) = 255;
+      }
+    }
+  }
 
-  std::vector<std::vector<int>> matrix(l1 + 1, std::vector<int>(l2 + 1));
+  cv::Mat labels, stats, centroids;
+  const int num_labels = cv::connectedComponentsWithStats(changed, labels, stats, centroids, 8);
 
-  for (auto i = 0; i <= l1; ++i) {
-    matrix[i][0] = i;
+  std::vector<cv::Rect> regions;
+  for (int i = 1; i < num_labels; ++i) {
+    const cv::Rect blocks(stats.at<int>(i, cv::CC_STAT_LEFT), stats.at<int>(i, cv::CC_STAT_TOP),
+                          stats.at<int>(i, cv::CC_STAT_WIDTH), stats.at<int>(i, cv::CC_STAT_HEIGHT));
+    regions.push_back(cv::Rect(blocks.x * block_size, blocks.y * block_size, blocks.width * block_size,
+                               blocks.height * block_size) &
+                      bounds);
   }
+  return regions;
+}
 
-  for (auto j = 0; j <= l2; ++j) {
-    matrix[0][j] = j;
+auto GrowChangedRegions(std::vector<cv::Rect> regions, const std::vector<cv::Rect> &boxes, int margin,
+                        const cv::Rect &bounds) noexcept -> std::vector<cv::Rect> {
+  for (auto &region : regions) {
+    region = cv::Rect(region.x - margin, region.y - margin, region.width + 2 * margin, region.height + 2 * margin) &
+             bounds;
   }
 
-  for (auto i = 1; i <= l1; ++i) {
-    for (auto j = 1; j <= l2; ++j) {
-      int cost = (s1[i - 1] == s2[j - 1]) ? 0 : 1;
+  // Growing a region by a box can make it overlap another region, and merging two regions can make them touch a box
+  // that neither touched, so both are repeated until nothing changes.
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (auto &region : regions) {
+      for (const auto &box : boxes) {
+        if ((box & region).area() > 0) {
+          const cv::Rect grown = (region | box) & bounds;
+          if (grown != region) {
+            region = grown;
+            changed = true;
+          }
+        }
+      }
+    }
 
-      matrix[i][j] = std::min({matrix[i - 1][j] + 1, matrix[i][j - 1] + 1, matrix[i - 1][j - 1] + cost});
+    for (size_t i = 0; i < regions.size(); ++i) {
+      for (size_t j = i + 1; j < regions.size();) {
+        if ((regions[i] & regions[j]).area() > 0) {
+          regions[i] |= regions[j];
+          regions.erase(regions.begin() + j);
+          changed = true;
+        } else {
+          ++j;
+        }
+      }
     }
   }
+  return regions;
+}
 
-  return matrix[l1][l2];
+namespace {
+
+/**
+ * @brief Maps a character for the comparison, folding the case if requested.
+ */
+template <bool kFoldCase>
+inline auto FoldChar(char c) noexcept -> unsigned char {
+  const auto uc = static_cast<unsigned char>(c);
+  if constexpr (kFoldCase) {
+    return static_cast<unsigned char>(std::tolower(uc));
+  } else {
+    return uc;
+  }
+}
+
+/**
+ * @brief Computes the bit mask of the positions of every character in the pattern, as used by MyersDistance().
+ */
+template <bool kFoldCase>
+auto BuildPeq(std::string_view pattern, std::array<std::uint64_t, 256> &peq) noexcept -> void {
+  peq.fill(0);
+  for (size_t i = 0; i < pattern.size(); ++i) {
+    peq[FoldChar<kFoldCase>(pattern[i])] |= std::uint64_t{1} << i;
+  }
+}
+
+/**
+ * @brief Myers' bit-parallel edit distance, in Hyyrö's formulation, for a pattern of 1 to 64 characters.
+ *
+ * @details One 64-bit word holds the vertical deltas of a whole column of the dynamic programming matrix, so every
+ * character of the text costs a handful of bitwise operations and no memory is allocated. The computation stops as
+ * soon as the distance cannot end below the budget anymore.
+ */
+template <bool kFoldCase>
+auto MyersDistance(const std::array<std::uint64_t, 256> &peq, size_t pattern_size, std::string_view text,
+                   int max_distance) noexcept -> int {
+  const std::uint64_t last = std::uint64_t{1} << (pattern_size - 1);
+  std::uint64_t pv = ~std::uint64_t{0};
+  std::uint64_t mv = 0;
+  int score = static_cast<int>(pattern_size);
+  const int n = static_cast<int>(text.size());
+
+  for (int j = 0; j < n; ++j) {
+    const std::uint64_t eq = peq[FoldChar<kFoldCase>(text[j])];
+    const std::uint64_t xv = eq | mv;
+    const std::uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+    std::uint64_t ph = mv | ~(xh | pv);
+    std::uint64_t mh = pv & xh;
+
+    if (ph & last) {
+      ++score;
+    } else if (mh & last) {
+      --score;
+    }
+    // The distance decreases by at most one per remaining character of the text.
+    if (score - (n - 1 - j) > max_distance) {
+      return max_distance + 1;
+    }
+
+    ph = (ph << 1) | 1;
+    mh <<= 1;
+    pv = mh | ~(xv | ph);
+    mv = ph & xv;
+  }
+
+  return std::min(score, max_distance + 1);
 }
 
+/**
+ * @brief Dynamic programming edit distance restricted to the diagonal band that can stay within the budget.
+ *
+ * @details Only two rows are kept, on the stack for short strings. The computation stops as soon as a whole row
+ * exceeds the budget.
+ */
+template <bool kFoldCase>
+auto BandedDistance(std::string_view s1, std::string_view s2, int max_distance) noexcept -> int {
+  constexpr int kStackColumns = 256;
+  const int l1 = static_cast<int>(s1.size());
+  const int l2 = static_cast<int>(s2.size());
+  const int exceeded = max_distance + 1;
+
+  std::array<int, 2 * (kStackColumns + 1)> stack_rows;
+  std::vector<int> heap_rows;
+  int *prev = stack_rows.data();
+  if (l2 > kStackColumns) {
+    heap_rows.resize(2 * (static_cast<size_t>(l2) + 1));
+    prev = heap_rows.data();
+  }
+  int *curr = prev + l2 + 1;
+
+  for (int j = 0; j <= l2; ++j) {
+    prev[j] = std::min(j, exceeded);
+  }
+
+  for (int i = 1; i <= l1; ++i) {
+    const int lo = std::max(1, i - max_distance);
+    const int hi = std::min(l2, i + max_distance);
+    const unsigned char c1 = FoldChar<kFoldCase>(s1[i - 1]);
+
+    curr[lo - 1] = lo == 1 ? std::min(i, exceeded) : exceeded;
+    int row_min = curr[lo - 1];
+    for (int j = lo; j <= hi; ++j) {
+      const int cost = c1 == FoldChar<kFoldCase>(s2[j - 1]) ? 0 : 1;
+      const int value = std::min({prev[j - 1] + cost, prev[j] + 1, curr[j - 1] + 1, exceeded});
+      curr[j] = value;
+      row_min = std::min(row_min, value);
+    }
+    if (hi < l2) {
+      curr[hi + 1] = exceeded;
+    }
+
+    if (row_min > max_distance) {
+      return exceeded;
+    }
+    std::swap(prev, curr);
+  }
+
+  return std::min(prev[l2], exceeded);
+}
+
+/**
+ * @brief Dispatches to the bit-parallel kernel when the shorter string fits in a machine word.
+ */
+template <bool kFoldCase>
+auto BoundedDistance(std::string_view s1, std::string_view s2, int max_distance) noexcept -> int {
+  if (s1.size() > s2.size()) {
+    std::swap(s1, s2);
+  }
+  max_distance = std::max(max_distance, 0);
+
+  const int length_gap = static_cast<int>(s2.size() - s1.size());
+  if (length_gap > max_distance) {
+    return max_distance + 1;
+  }
+  if (s1.empty()) {
+    return length_gap;
+  }
+  if (s1.size() <= 64) {
+    std::array<std::uint64_t, 256> peq;
+    BuildPeq<kFoldCase>(s1, peq);
+    return MyersDistance<kFoldCase>(peq, s1.size(), s2, max_distance);
+  }
+  return BandedDistance<kFoldCase>(s1, s2, max_distance);
+}
+
+}  // namespace
+
+auto CalcLevenshteinDistance(std::string_view s1, std::string_view s2) noexcept -> int {
+  return CalcLevenshteinDistance(s1, s2, static_cast<int>(std::max(s1.size(), s2.size())));
+}
+
+auto CalcLevenshteinDistance(std::string_view s1, std::string_view s2, int max_distance, bool case_sensitive) noexcept
+    -> int {
+  return case_sensitive ? BoundedDistance<false>(s1, s2, max_distance) : BoundedDistance<true>(s1, s2, max_distance);
+}
+
+LevenshteinPattern::LevenshteinPattern(std::string_view pattern, bool case_sensitive)
+    : pattern_(pattern), case_sensitive_(case_sensitive) {
+  if (case_sensitive_) {
+    BuildPeq<false>(pattern_, peq_);
+  } else {
+    BuildPeq<true>(pattern_, peq_);
+  }
+}
+
+auto LevenshteinPattern::Distance(std::string_view text, int max_distance) const noexcept -> int {
+  max_distance = std::max(max_distance, 0);
+  const int length_gap = std::abs(static_cast<int>(pattern_.size()) - static_cast<int>(text.size()));
+  if (length_gap > max_distance) {
+    return max_distance + 1;
+  }
+  if (pattern_.empty() || text.empty()) {
+    return length_gap;
+  }
+  if (pattern_.size() <= 64) {
+    return case_sensitive_ ? MyersDistance<false>(peq_, pattern_.size(), text, max_distance)
+                           : MyersDistance<true>(peq_, pattern_.size(), text, max_distance);
+  }
+  return case_sensitive_ ? BandedDistance<false>(pattern_, text, max_distance)
+                         : BandedDistance<true>(pattern_, text, max_distance);
+}
+
+auto LevenshteinPattern::GetPattern() const noexcept -> std::string_view { return pattern_; }
+
 auto SplitStr(const std::string &s) noexcept -> std::vector<std::string> {
   std::istringstream iss(s);
   std::vector<std::string> tokens;
@@ -128,3 +422,81 @@ static inline std::string rtrim(const std::string &s) {
 static inline std::string trim(const std::string &s) { return ltrim(rtrim(s)); }
 
 auto TrimStr(const std::string &s) noexcept -> std::string { return trim(s); }
+
+auto ToJsonString(std::string_view text) -> std::string {
+  std::string result = "\"";
+  for (const char c : text) {
+    if (c == '"' || c == '\\') {
+      result += '\\';
+      result += c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      result += fmt::format("\\u{:04x}", static_cast<int>(c));
+    } else {
+      result += c;
+    }
+  }
+  result += '"';
+  return result;
+}
+
+auto FromJsonString(std::string_view text) -> std::optional<std::string> {
+  if (text.empty() || text[0] != '"') {
+    return std::nullopt;
+  }
+
+  std::string result;
+  for (std::size_t i = 1; i < text.size(); ++i) {
+    if (text[i] == '"') {
+      return result;
+    }
+    if (text[i] != '\\') {
+      result += text[i];
+      continue;
+    }
+    if (++i == text.size()) {
+      break;
+    }
+    switch (text[i]) {
+      case 'b':
+        result += '\b';
+        break;
+      case 'f':
+        result += '\f';
+        break;
+      case 'n':
+        result += '\n';
+        break;
+      case 'r':
+        result += '\r';
+        break;
+      case 't':
+        result += '\t';
+        break;
+      case 'u': {
+        unsigned int code = 0;
+        const char *digits = text.data() + i + 1;
+        if (i + 4 >= text.size() || std::from_chars(digits, digits + 4, code, 16).ptr != digits + 4) {
+          return std::nullopt;
+        }
+        i += 4;
+        // Encoded as UTF-8, surrogate pairs are not joined.
+        if (code < 0x80) {
+          result += static_cast<char>(code);
+        } else if (code < 0x800) {
+          result += static_cast<char>(0xC0 | (code >> 6));
+          result += static_cast<char>(0x80 | (code & 0x3F));
+        } else {
+          result += static_cast<char>(0xE0 | (code >> 12));
+          result += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+          result += static_cast<char>(0x80 | (code & 0x3F));
+        }
+        break;
+      }
+      default:
+        // \", \\ and \/ stand for the character itself.
+        result += text[i];
+        break;
+    }
+  }
+  return std::nullopt;
+}
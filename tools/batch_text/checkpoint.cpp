@@ -0,0 +1,35 @@
+#include "checkpoint.hpp"
+
+#include <algorithm>
+#include <string_view>
+
+#include "textspotter/utility.hpp"
+
+auto ReadCheckpoint(std::istream &in) -> Checkpoint {
+  Checkpoint checkpoint;
+  std::string line;
+  while (std::getline(in, line)) {
+    if (in.eof()) {
+      // The last line has no line break, it was cut short.
+      break;
+    }
+    checkpoint.complete_size_ = in.tellg();
+    // Every line starts with {"path":"...", in the quoting of ToJsonString.
+    constexpr std::string_view prefix = "{\"path\":";
+    if (line.compare(0, prefix.size(), prefix) != 0) {
+      continue;
+    }
+    if (auto path = FromJsonString(std::string_view(line).substr(prefix.size()))) {
+      checkpoint.done_.insert(std::move(*path));
+    }
+  }
+  return checkpoint;
+}
+
+auto RemoveDonePaths(std::vector<std::string> &paths, const Checkpoint &checkpoint) -> std::size_t {
+  const auto total = paths.size();
+  paths.erase(std::remove_if(paths.begin(), paths.end(),
+                             [&checkpoint](const auto &path) { return checkpoint.done_.count(path) > 0; }),
+              paths.end());
+  return total - paths.size();
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <istream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * @struct Checkpoint
+ * @brief What the output file of a previous run tells about it.
+ */
+struct Checkpoint {
+  std::unordered_set<std::string> done_;  // Paths of the images already processed.
+  std::streamoff complete_size_ = 0;      // Size of the complete lines, the rest of the file was cut short.
+};
+
+/**
+ * @brief Reads the output of a previous run, one JSON line per image starting with {"path":"...".
+ *
+ * @details Every line is flushed with its line break, so the lines that have one are complete. A last line without
+ * it was cut short by a crash and is ignored, its image is processed again.
+ *
+ * @param in The output of the previous run.
+ * @return The images already processed, and the size of the output to keep.
+ */
+auto ReadCheckpoint(std::istream &in) -> Checkpoint;
+
+/**
+ * @brief Removes the images already processed from the paths, keeping the order of the others.
+ *
+ * @param paths The paths of the images.
+ * @param checkpoint The images already processed.
+ * @return The number of paths removed.
+ */
+auto RemoveDonePaths(std::vector<std::string> &paths, const Checkpoint &checkpoint) -> std::size_t;
@@ -0,0 +1,300 @@
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <argparse/argparse.hpp>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <opencv2/core/utils/filesystem.hpp>
+#include <opencv2/opencv.hpp>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "checkpoint.hpp"
+#include "textspotter/bounded_queue.hpp"
+#include "textspotter/ocr.hpp"
+#include "textspotter/textspotter.hpp"
+#include "textspotter/thread_pool.hpp"
+#include "textspotter/threading.hpp"
+#include "textspotter/utility.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+/**
+ * @struct DecodedImage
+ * @brief An image decoded by the I/O threads, waiting for a worker.
+ */
+struct DecodedImage {
+  std::string path_;       // Path of the image, as listed in the input.
+  cv::Mat image_;          // The pixels, empty if the file cannot be decoded.
+  double decode_seconds_;  // Time spent decoding the file.
+};
+
+/**
+ * @brief Checks whether a path names a list of images rather than an image.
+ */
+static auto IsFileList(const std::string &path) -> bool {
+  const auto dot = path.rfind('.');
+  return dot != std::string::npos && (path.substr(dot) == ".txt" || path.substr(dot) == ".lst");
+}
+
+/**
+ * @brief Expands the inputs into image paths: directories are listed, lists are read, other paths are kept.
+ */
+static auto CollectImagePaths(const std::vector<std::string> &inputs, bool recursive) -> std::vector<std::string> {
+  std::vector<std::string> paths;
+  for (const auto &input : inputs) {
+    if (IsFileList(input)) {
+      std::ifstream list(input);
+      std::string line;
+      while (std::getline(list, line)) {
+        line = TrimStr(line);
+        if (!line.empty() && line[0] != '#') {
+          paths.push_back(line);
+        }
+      }
+    } else if (cv::utils::fs::isDirectory(input)) {
+      std::vector<cv::String> files;
+      cv::glob(input, files, recursive);
+      paths.insert(paths.end(), files.begin(), files.end());
+    } else {
+      paths.push_back(input);
+    }
+  }
+  return paths;
+}
+
+/**
+ * @brief Gets the recognition profile of a --profile value.
+ */
+static auto ParseProfile(const std::string &name) -> std::optional<RecognitionProfile> {
+  if (name == "block") {
+    return RecognitionProfile::Default();
+  }
+  if (name == "line") {
+    return RecognitionProfile::SingleLine();
+  }
+  if (name == "word") {
+    return RecognitionProfile::SingleWord();
+  }
+  if (name == "raw") {
+    return RecognitionProfile::RawLine();
+  }
+  return std::nullopt;
+}
+
+/**
+ * @brief Reads the paths already written to an output file, dropping the line a crash may have cut short.
+ *
+ * @return The paths of the images already processed.
+ */
+static auto ResumeFrom(const std::string &output_path) -> Checkpoint {
+  std::ifstream in(output_path, std::ios::binary);
+  if (!in) {
+    return {};
+  }
+  auto checkpoint = ReadCheckpoint(in);
+  in.close();
+
+  std::ifstream size_in(output_path, std::ios::binary | std::ios::ate);
+  if (static_cast<std::streamoff>(size_in.tellg()) != checkpoint.complete_size_) {
+    // Rewrite the complete lines only, so that the next line does not get appended to a broken one.
+    size_in.seekg(0);
+    std::string content(static_cast<std::size_t>(checkpoint.complete_size_), '\0');
+    size_in.read(content.data(), checkpoint.complete_size_);
+    size_in.close();
+    std::ofstream(output_path, std::ios::binary | std::ios::trunc).write(content.data(), checkpoint.complete_size_);
+  }
+  return checkpoint;
+}
+
+/**
+ * @brief Formats the results of an image as one JSON line.
+ */
+static auto ToJsonLine(const DecodedImage &decoded, const std::vector<DetectReadResult> &results,
+                       double detect_read_seconds) -> std::string {
+  if (decoded.image_.empty()) {
+    return fmt::format("{{\"path\":{},\"error\":\"cannot decode the image\"}}\n", ToJsonString(decoded.path_));
+  }
+
+  std::string words;
+  for (const auto &result : results) {
+    const auto &box = result.bounding_box_;
+    words += fmt::format("{}{{\"text\":{},\"box\":[{},{},{},{}],\"conf\":{:.1f}}}", words.empty() ? "" : ",",
+                         ToJsonString(result.text_), box.x, box.y, box.width, box.height, result.conf_);
+  }
+  return fmt::format(
+      "{{\"path\":{},\"width\":{},\"height\":{},\"decode_seconds\":{:.4f},\"detect_read_seconds\":{:.4f},"
+      "\"words\":[{}]}}\n",
+      ToJsonString(decoded.path_), decoded.image_.cols, decoded.image_.rows, decoded.decode_seconds_,
+      detect_read_seconds, words);
+}
+
+int main(int argc, char *argv[]) {
+  argparse::ArgumentParser parser("TextSpotter::BatchText");
+  parser.add_argument("inputs")
+      .help("images, directories of images, or .txt/.lst files listing one image per line")
+      .nargs(argparse::nargs_pattern::at_least_one);
+  parser.add_argument("--dtm").help("path to east detection model").required();
+  parser.add_argument("--output").help("JSON Lines file the results are written to").default_value("results.jsonl");
+  parser.add_argument("--workers")
+      .help("number of images processed at once, each worker keeps its own models, 0 means one per hardware thread")
+      .default_value(0)
+      .scan<'i', int>();
+  parser.add_argument("--threads")
+      .help("number of cores shared by the workers and OpenCV, 0 leaves every library to size itself")
+      .default_value(0)
+      .scan<'i', int>();
+  parser.add_argument("--io-threads").help("number of threads decoding images").default_value(2).scan<'i', int>();
+  parser.add_argument("--recursive").help("list the directories recursively").flag();
+  parser.add_argument("--resume").help("skip the images already in the output file and append to it").flag();
+  parser.add_argument("--profile")
+      .help("how regions are recognized: block (layout analysis), line, word or raw (single line, no dictionary)")
+      .default_value(std::string("block"));
+  parser.add_argument("--merge-boxes")
+      .help("merge the boxes of a line before recognition and drop the words read twice")
+      .flag();
+  parser.add_argument("--tiled").help("detect tile by tile at native resolution, for large screenshots").flag();
+
+  try {
+    parser.parse_args(argc, argv);
+  } catch (const std::exception &e) {
+    fmt::println(stderr, e.what());
+    fmt::println(stderr, parser.help().str());
+    exit(1);
+  }
+
+  const auto model_path = parser.get<std::string>("--dtm");
+  const auto output_path = parser.get<std::string>("--output");
+  const bool resume = parser["--resume"] == true;
+  const auto num_workers = parser.get<int>("--workers") > 0 ? static_cast<std::size_t>(parser.get<int>("--workers"))
+                                                            : std::max(1U, std::thread::hardware_concurrency());
+  const auto num_io_threads = static_cast<std::size_t>(std::max(parser.get<int>("--io-threads"), 1));
+  const auto profile = ParseProfile(parser.get<std::string>("--profile"));
+  if (!profile) {
+    fmt::println(stderr, "Unknown recognition profile {}", parser.get<std::string>("--profile"));
+    exit(1);
+  }
+
+  auto paths = CollectImagePaths(parser.get<std::vector<std::string>>("inputs"), parser["--recursive"] == true);
+  if (resume) {
+    const auto total = paths.size();
+    const auto num_done = RemoveDonePaths(paths, ResumeFrom(output_path));
+    fmt::println("Resuming: {} of {} images already processed", num_done, total);
+  }
+
+  std::ofstream output(output_path, resume ? std::ios::app : std::ios::trunc);
+  if (!output) {
+    fmt::println(stderr, "Cannot open {}", output_path);
+    exit(1);
+  }
+
+  DetectReadOptions options;
+  options.tiled_detection_ = parser["--tiled"] == true;
+  if (parser["--merge-boxes"] == true) {
+    options.merge_boxes_ = true;
+    options.duplicate_iou_threshold_ = 0.5F;
+  }
+
+  if (parser.get<int>("--threads") > 0) {
+    // Every worker recognizes on its own thread, OpenCV gets the rest of the cores.
+    ThreadingConfig threading;
+    threading.total_threads_ = static_cast<std::size_t>(parser.get<int>("--threads"));
+    threading.ocr_threads_ = num_workers;
+    ApplyThreadingConfig(threading);
+    options.omp_num_threads_ = 1;
+  }
+
+  std::mutex output_mutex;
+  std::atomic<std::size_t> num_processed = 0;
+  std::atomic<std::size_t> num_failed = 0;
+  std::atomic<std::size_t> num_words = 0;
+  std::atomic<bool> load_failed = false;
+  const auto start = Clock::now();
+
+  // Decoded images wait in a short queue, so that the I/O threads do not run ahead of the workers and fill the memory.
+  BoundedQueue<DecodedImage> queue(2 * num_workers);
+  ThreadPool io_pool(num_io_threads);
+  std::thread feeder([&paths, &queue, &io_pool, &load_failed]() {
+    std::vector<std::future<void>> decoded;
+    decoded.reserve(paths.size());
+    for (const auto &path : paths) {
+      decoded.push_back(io_pool.Submit([&path, &queue, &load_failed]() {
+        if (load_failed) {
+          return;
+        }
+        const auto decode_start = Clock::now();
+        auto image = cv::imread(path, cv::IMREAD_COLOR);
+        const std::chrono::duration<double> elapsed = Clock::now() - decode_start;
+        queue.Push({path, std::move(image), elapsed.count()});
+      }));
+    }
+    for (auto &future : decoded) {
+      future.get();
+    }
+    queue.Close();
+  });
+
+  std::vector<std::thread> workers;
+  for (std::size_t w = 0; w < num_workers; ++w) {
+    workers.emplace_back([&]() {
+      // The images are processed in parallel, so every worker recognizes its regions on its own thread.
+      TextSpotter text_spotter(model_path, false, 1);
+      text_spotter.SetDetectReadOptions(options);
+      text_spotter.SetRecognitionProfile(*profile);
+      try {
+        text_spotter.Warmup();
+      } catch (const std::exception &e) {
+        if (!load_failed.exchange(true)) {
+          fmt::println(stderr, "Cannot load the models: {}", e.what());
+        }
+        queue.Cancel();
+        return;
+      }
+
+      while (auto decoded = queue.Pop()) {
+        double seconds = 0.0;
+        const std::vector<DetectReadResult> *results = nullptr;
+        static const std::vector<DetectReadResult> no_results;
+        if (decoded->image_.empty()) {
+          ++num_failed;
+          results = &no_results;
+        } else {
+          const auto detect_start = Clock::now();
+          text_spotter.LoadImageView(decoded->image_);
+          results = &text_spotter.DetectRead();
+          seconds = std::chrono::duration<double>(Clock::now() - detect_start).count();
+          num_words += results->size();
+        }
+
+        const auto line = ToJsonLine(*decoded, *results, seconds);
+        const std::lock_guard lock(output_mutex);
+        // One flushed line per image is the checkpoint --resume starts from.
+        output << line << std::flush;
+        const auto processed = ++num_processed;
+        if (processed % 100 == 0) {
+          const std::chrono::duration<double> elapsed = Clock::now() - start;
+          fmt::println(stderr, "{} / {} images, {:.2f} images/s", processed, paths.size(),
+                       static_cast<double>(processed) / elapsed.count());
+        }
+      }
+    });
+  }
+
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  feeder.join();
+
+  if (load_failed) {
+    return 1;
+  }
+  const std::chrono::duration<double> elapsed = Clock::now() - start;
+  fmt::println("Processed {} images ({} undecodable), {} words in {:.2f} seconds with {} workers: {:.2f} images/s",
+               num_processed.load(), num_failed.load(), num_words.load(), elapsed.count(), num_workers,
+               elapsed.count() > 0 ? static_cast<double>(num_processed) / elapsed.count() : 0.0);
+  return 0;
+}
@@ -12,6 +12,7 @@ int main(int argc, char *argv[]) {
   parser.add_argument("image").help("path to image").required();
   parser.add_argument("--dtm").help("path to east detection model").required();
   parser.add_argument("--multi-thread").help("enable multi-thread").flag();
+  parser.add_argument("--native").help("keep the native resolution of the image instead of resizing it").flag();
 
   try {
     parser.parse_args(argc, argv);
@@ -24,7 +25,7 @@ int main(int argc, char *argv[]) {
   const auto image_path = parser.get<std::string>("image");
   const auto model_path = parser.get<std::string>("--dtm");
 
-  cv::Mat image = LoadImage(image_path);
+  cv::Mat image = parser["--native"] == true ? LoadImage(image_path, cv::Size()) : LoadImage(image_path);
 
   if (parser["--multi-thread"] == true) {
     fmt::println("Multi-thread enabled");
@@ -3,6 +3,7 @@
 #include <argparse/argparse.hpp>
 #include <opencv2/opencv.hpp>
 
+#include "textspotter/metrics.hpp"
 #include "textspotter/textspotter.hpp"
 #include "textspotter/utility.hpp"
 
@@ -12,6 +13,9 @@ int main(int argc, char *argv[]) {
   parser.add_argument("--dtm").help("path to east detection model").required();
   parser.add_argument("--multi-thread").help("enable multi-thread").flag();
   parser.add_argument("--display").help("display image after each matching").flag();
+  parser.add_argument("--lazy").help("only detect up front, recognize the regions each query needs").flag();
+  parser.add_argument("--metrics")
+      .help("save the stage timings and counters on exit, as JSON if the path ends with .json, else for Prometheus");
 
   try {
     parser.parse_args(argc, argv);
@@ -31,16 +35,27 @@ int main(int argc, char *argv[]) {
   }
 
   TextSpotter text_spotter(model_path, enable_multi_thread);
+  const auto lazy = parser["--lazy"] == true;
+  text_spotter.SetLazyRecognition(lazy);
+  const auto metrics_path = parser.present<std::string>("--metrics");
+  if (metrics_path) {
+    text_spotter.EnableMetrics();
+  }
+  text_spotter.Warmup();
   const auto image = LoadImage(image_path);
-  text_spotter.LoadImage(image);
+  text_spotter.LoadImageView(image);
 
   fmt::println("Start detecting...");
   Timer timer;
   timer.Start();
-  const auto detect_read_result = text_spotter.DetectRead();
+  const auto &detect_read_result = text_spotter.DetectRead();
   timer.End();
 
-  fmt::println("Detect and read {} texts in {} seconds", detect_read_result.size(), timer.GetElapsedSeconds());
+  if (lazy) {
+    fmt::println("Detect text in {:.3f} seconds, regions are read on demand", timer.GetElapsedSeconds());
+  } else {
+    fmt::println("Detect and read {} texts in {:.3f} seconds", detect_read_result.size(), timer.GetElapsedSeconds());
+  }
   fmt::println("Start interactive matching: (type \\quit to quit)");
 
   cv::Point pt;
@@ -53,9 +68,11 @@ int main(int argc, char *argv[]) {
     }
 
     target = TrimStr(target);
+    timer.Start();
     pt = text_spotter.MatchText(target);
+    timer.End();
 
-    fmt::println("Found @ ({}, {})", pt.x, pt.y);
+    fmt::println("Found @ ({}, {}) in {:.3f} seconds", pt.x, pt.y, timer.GetElapsedSeconds());
 
     if (display) {
       const auto canvas = image.clone();
@@ -67,5 +84,13 @@ int main(int argc, char *argv[]) {
     }
   }
 
+  if (metrics_path) {
+    const bool json = metrics_path->size() >= 5 && metrics_path->compare(metrics_path->size() - 5, 5, ".json") == 0;
+    if (!text_spotter.GetMetrics()->Save(*metrics_path, json ? MetricsFormat::kJson : MetricsFormat::kPrometheus)) {
+      fmt::println(stderr, "Cannot save the metrics to {}", *metrics_path);
+      return 1;
+    }
+  }
+
   return 0;
 }
@@ -0,0 +1,145 @@
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <argparse/argparse.hpp>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "textspotter/text_matching.hpp"
+#include "textspotter/utility.hpp"
+
+/**
+ * @brief The full matrix implementation CalcLevenshteinDistance used to have, kept as the baseline.
+ */
+static auto FullMatrixDistance(std::string_view s1, std::string_view s2) -> int {
+  const int l1 = s1.size();
+  const int l2 = s2.size();
+  std::vector<std::vector<int>> matrix(l1 + 1, std::vector<int>(l2 + 1));
+  for (auto i = 0; i <= l1; ++i) {
+    matrix[i][0] = i;
+  }
+  for (auto j = 0; j <= l2; ++j) {
+    matrix[0][j] = j;
+  }
+  for (auto i = 1; i <= l1; ++i) {
+    for (auto j = 1; j <= l2; ++j) {
+      const int cost = (s1[i - 1] == s2[j - 1]) ? 0 : 1;
+      matrix[i][j] = std::min({matrix[i - 1][j] + 1, matrix[i][j - 1] + 1, matrix[i - 1][j - 1] + cost});
+    }
+  }
+  return matrix[l1][l2];
+}
+
+/**
+ * @brief The IsMatch implementation before the bounded kernel, kept as the baseline.
+ */
+static auto FullMatrixIsMatch(std::string_view s1, std::string_view s2) -> bool {
+  const auto str1 = ToLower(s1);
+  const auto str2 = ToLower(s2);
+  const auto min_length = std::min(str1.length(), str2.length());
+  const auto edit_dist = FullMatrixDistance(str1, str2);
+  return edit_dist < static_cast<int>(min_length / 2);
+}
+
+/**
+ * @brief Generates pairs of words looking like OCR output: random words, half of them compared with a slightly
+ * misread copy of themselves.
+ */
+static auto GeneratePairs(int num_pairs, int max_length, unsigned seed)
+    -> std::vector<std::pair<std::string, std::string>> {
+  std::mt19937 rng(seed);
+  std::uniform_int_distribution<int> length_dist(1, std::max(max_length, 1));
+  std::uniform_int_distribution<int> char_dist('a', 'z');
+
+  const auto random_word = [&]() {
+    std::string word(length_dist(rng), ' ');
+    for (auto &c : word) {
+      c = static_cast<char>(char_dist(rng));
+    }
+    return word;
+  };
+
+  std::vector<std::pair<std::string, std::string>> pairs;
+  pairs.reserve(num_pairs);
+  for (int i = 0; i < num_pairs; ++i) {
+    auto word = random_word();
+    if (i % 2 == 0) {
+      pairs.emplace_back(std::move(word), random_word());
+      continue;
+    }
+    auto misread = word;
+    misread[rng() % misread.size()] = static_cast<char>(char_dist(rng));
+    if (rng() % 2 == 0) {
+      misread.push_back(static_cast<char>(char_dist(rng)));
+    }
+    pairs.emplace_back(std::move(word), std::move(misread));
+  }
+  return pairs;
+}
+
+/**
+ * @brief Runs the function on every pair and returns the mean duration of one call in nanoseconds.
+ */
+template <typename Function>
+static auto MeasureNanoseconds(const std::vector<std::pair<std::string, std::string>> &pairs, int repeats,
+                               Function &&function, long long &checksum) -> double {
+  const auto start = std::chrono::steady_clock::now();
+  for (int r = 0; r < repeats; ++r) {
+    for (const auto &[s1, s2] : pairs) {
+      checksum += function(s1, s2);
+    }
+  }
+  const auto end = std::chrono::steady_clock::now();
+  const auto total = std::chrono::duration<double, std::nano>(end - start).count();
+  return total / (static_cast<double>(pairs.size()) * repeats);
+}
+
+int main(int argc, char *argv[]) {
+  argparse::ArgumentParser parser("TextSpotter::LevenshteinBenchmark");
+  parser.add_argument("--pairs").help("number of word pairs").default_value(100000).scan<'i', int>();
+  parser.add_argument("--max-length").help("maximum length of a word").default_value(16).scan<'i', int>();
+  parser.add_argument("--repeats").help("number of passes over the pairs").default_value(10).scan<'i', int>();
+  parser.add_argument("--seed").help("seed of the word generator").default_value(42).scan<'i', int>();
+
+  try {
+    parser.parse_args(argc, argv);
+  } catch (const std::exception &e) {
+    fmt::println(stderr, e.what());
+    fmt::println(stderr, parser.help().str());
+    exit(1);
+  }
+
+  const auto pairs = GeneratePairs(parser.get<int>("--pairs"), parser.get<int>("--max-length"),
+                                   static_cast<unsigned>(parser.get<int>("--seed")));
+  const auto repeats = std::max(parser.get<int>("--repeats"), 1);
+
+  for (const auto &[s1, s2] : pairs) {
+    if (FullMatrixDistance(s1, s2) != CalcLevenshteinDistance(s1, s2) ||
+        FullMatrixIsMatch(s1, s2) != IsMatch(s1, s2)) {
+      fmt::println(stderr, "Mismatched on {} and {}", s1, s2);
+      return 1;
+    }
+  }
+
+  // The checksums keep the compiler from discarding the calls.
+  long long full_checksum = 0;
+  long long kernel_checksum = 0;
+  const auto full_distance = MeasureNanoseconds(pairs, repeats, FullMatrixDistance, full_checksum);
+  const auto kernel_distance = MeasureNanoseconds(
+      pairs, repeats, [](std::string_view s1, std::string_view s2) { return CalcLevenshteinDistance(s1, s2); },
+      kernel_checksum);
+  const auto full_match = MeasureNanoseconds(pairs, repeats, FullMatrixIsMatch, full_checksum);
+  const auto kernel_match = MeasureNanoseconds(
+      pairs, repeats, [](std::string_view s1, std::string_view s2) { return IsMatch(s1, s2); }, kernel_checksum);
+
+  fmt::println("{} pairs of up to {} characters, {} passes", pairs.size(), parser.get<int>("--max-length"), repeats);
+  fmt::println("Distance: full matrix {:.1f} ns, kernel {:.1f} ns, speedup {:.1f}x", full_distance, kernel_distance,
+               full_distance / kernel_distance);
+  fmt::println("IsMatch:  full matrix {:.1f} ns, kernel {:.1f} ns, speedup {:.1f}x", full_match, kernel_match,
+               full_match / kernel_match);
+  fmt::println("Checksums: {} {}", full_checksum, kernel_checksum);
+
+  return 0;
+}
@@ -0,0 +1,59 @@
+#include <fmt/core.h>
+
+#include <argparse/argparse.hpp>
+#include <opencv2/opencv.hpp>
+
+#include "textspotter/textspotter_stream.hpp"
+
+int main(int argc, char *argv[]) {
+  argparse::ArgumentParser parser("TextSpotter::StreamText");
+  parser.add_argument("--dtm").help("path to east detection model").required();
+  parser.add_argument("--video").help("path to a video file or number of a camera, synthetic frames if omitted");
+  parser.add_argument("--frames").help("number of synthetic frames").default_value(100).scan<'i', int>();
+  parser.add_argument("--target")
+      .help("text to match in every frame")
+      .append()
+      .default_value(std::vector<std::string>{});
+  parser.add_argument("--no-drop").help("process every frame instead of dropping frames under load").flag();
+
+  try {
+    parser.parse_args(argc, argv);
+  } catch (const std::exception &e) {
+    fmt::println(stderr, e.what());
+    fmt::println(stderr, parser.help().str());
+    exit(1);
+  }
+
+  const auto model_path = parser.get<std::string>("--dtm");
+  const auto targets = parser.get<std::vector<std::string>>("--target");
+
+  TextSpotterStream::FrameSource source;
+  try {
+    source = parser.present("--video") ? TextSpotterStream::OpenVideo(parser.get<std::string>("--video"))
+                                       : TextSpotterStream::SyntheticVideo(parser.get<int>("--frames"));
+  } catch (const std::exception &e) {
+    fmt::println(stderr, e.what());
+    exit(1);
+  }
+
+  TextSpotterStream stream(model_path, 0, 2, parser["--no-drop"] == false);
+  stream.SetTargets(targets);
+  stream.Start(std::move(source), [&targets](const StreamFrameResult &result) {
+    fmt::print("Frame {}: {} words in {:.3f} seconds", result.frame_index_, result.detections_.size(),
+               result.latency_seconds_);
+    for (std::size_t i = 0; i < result.matches_.size(); ++i) {
+      const auto &point = result.matches_[i].point_;
+      fmt::print(", {} @ ({}, {})", targets[i], point.x, point.y);
+    }
+    fmt::println("");
+  });
+  stream.Wait();
+
+  for (const auto &stats : stream.GetStageStats()) {
+    const auto mean = stats.frames_ > 0 ? stats.total_seconds_ / static_cast<double>(stats.frames_) : 0.0;
+    fmt::println("{:>10}: {} frames, {} dropped, mean {:.4f} s, max {:.4f} s", stats.name_, stats.frames_,
+                 stats.dropped_, mean, stats.max_seconds_);
+  }
+
+  return 0;
+}